@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Map.h"
+
+namespace benchmark
+{
+    // One measured comparison, printed as a table. Cells are already formatted.
+    struct Table
+    {
+        std::string title;
+        std::vector<std::string> columns;
+        std::vector<std::vector<std::string>> rows;
+    };
+
+    // The best time of one call to job over several batches, in microseconds. The job should feed its
+    // results to consume() so the optimiser can't drop the work.
+    double timeMicroseconds(const std::function<void()>& job);
+
+    void consume(float value);
+
+    // Grid cells visited per ray by the DDA walk against cells probed by the two stepping loops it
+    // replaced, and how many rays each fails to find a wall for.
+    std::vector<Table> stepsPerRay(const world::Map& map, float hfov, unsigned seed);
+
+    // How each column's ray direction is made: from per-column atan2, sine and cosine, from the camera
+    // plane, or from the fine tables along the column's binary angle. Also how far the fine angle
+    // walls are cast along strays from the camera plane ray the floors use, and how many columns
+    // snap onto the same fine angle as their neighbour.
+    std::vector<Table> rayDirections(const world::Map& map, float hfov, unsigned seed);
+
+    // The float cast against the 16.16 fixed point cast: time per ray, and how far their hits differ.
+    std::vector<Table> fixedPoint(const world::Map& map, unsigned seed);
+
+    // Full castRays frames against castRaysCoherent at several span widths, on the given map and on
+    // open ones, and how many columns the spans resolve differently.
+    std::vector<Table> coherentSpans(const world::Map& map, float hfov, unsigned seed);
+
+    // Turning in place from seeded poses with the hit cache against casting every column, and how
+    // many columns the cache resolves.
+    std::vector<Table> hitCache(const world::Map& map, float hfov, unsigned seed);
+
+    // The cell by cell walk against cast(), on maps from dense to empty, with the mean wall distance
+    // that decides whether cast() jumps across empty space.
+    std::vector<Table> distanceField(const world::Map& map, unsigned seed);
+
+    // Filling, drawing the walls into and uploading a row-major framebuffer against the column-major
+    // one and the palette indexed one, seen from the middle of the given map and from beside a wall.
+    // Also the upload alone, for packed pixels and for each kernel expanding palette indices.
+    std::vector<Table> framebufferLayout(const world::Map& map, float hfov);
+
+    // Every benchmark, on the given map where one is needed.
+    std::vector<Table> run(const world::Map& map, float hfov, unsigned seed);
+}
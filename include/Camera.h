@@ -0,0 +1,57 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Maths.h"
+
+namespace rendering
+{
+    // View direction and camera plane. The plane is perpendicular to the direction and scaled so
+    // that offsets of -1 and 1 along it land on the edges of the horizontal field of view.
+    struct Camera
+    {
+        float dirX;
+        float dirY;
+        float planeX;
+        float planeY;
+
+        static Camera fromDirection(float dirX, float dirY, float planeScale);
+        static Camera fromAngle(maths::BinaryAngle angle, float planeScale);
+    };
+
+    // Per-column camera plane offsets, each column's binary angle from the view direction and the
+    // cosine of that angle. Rays are cast along the view angle plus the column angle, which keeps
+    // every ray on a fine angle; the cosine removes the fisheye effect.
+    class ColumnTable
+    {
+    public:
+        // Rebuilds the table only when the screen width, ray resolution or field of view changed.
+        void rebuild(int screenWidth, int rayRes, float hfov);
+
+        int size() const { return static_cast<int>(offsets.size()); }
+
+        // tan(hfov / 2), the camera plane's length for a unit view direction.
+        float getPlaneScale() const { return planeScale; }
+
+        std::span<const float> getOffsets() const { return offsets; }
+        std::span<const float> getCosines() const { return cosines; }
+        std::span<const maths::BinaryAngle> getAngles() const { return angles; }
+
+        // Column angles are rounded to multiples of this power of two, at most a quarter of the
+        // narrowest gap between columns. A view turned by multiples of it casts along angles earlier
+        // frames already cast, which keeps a hit cache keyed by angle hitting while it rotates.
+        int getAngleStep() const { return angleStep; }
+
+    private:
+        int screenWidth{0};
+        int rayRes{0};
+        float hfov{0.0f};
+        float planeScale{0.0f};
+        int angleStep{1};
+
+        std::vector<float> offsets;
+        std::vector<float> cosines;
+        std::vector<maths::BinaryAngle> angles;
+    };
+}
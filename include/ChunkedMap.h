@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace world
+{
+    // A map too large to keep in memory, stored on disk as square chunks and streamed in around the
+    // player by a background thread. Chunk lookups go through a flat directory with a border of solid
+    // chunks, so a walk only touches it when crossing into another chunk and never needs a bounds check.
+    class ChunkedMap
+    {
+    public:
+        static constexpr int CHUNK_SHIFT = 6;
+        static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+        // Chunks kept loaded in every direction around the player, and chunks fetched ahead of them
+        // along the heading.
+        static constexpr int LOAD_RADIUS = 2;
+        static constexpr int PREFETCH_CHUNKS = 4;
+
+        // A chunk that fails to read waits this many updates before it is queued again, doubling with
+        // each failure in a row up to MAX_RETRY_SHIFT doublings.
+        static constexpr int READ_RETRY_FRAMES = 30;
+        static constexpr int MAX_RETRY_SHIFT = 4;
+
+        // One chunk's cells: an occupancy word per row, and the materials read at hit time.
+        struct Chunk
+        {
+            std::array<std::uint64_t, CHUNK_SIZE> rows{};
+            std::array<std::uint8_t, CHUNK_SIZE * CHUNK_SIZE> materials{};
+
+            // False for the border and for chunks still on disk, which read as solid.
+            bool isResident{false};
+
+            bool isWall(const int localX, const int localY) const
+            {
+                return (rows[localY] >> localX & 1) != 0;
+            }
+        };
+
+        // Writes a map file a chunk at a time, so the whole map never has to be in memory. Cell values
+        // are stored through toMaterial.
+        static bool write(const std::string& path, int width, int height, const std::function<int(int x, int y)>& cellAt);
+
+        // Opens a map file and starts its loader thread, or returns null if the file can't be read.
+        // At most residentBudget chunks are kept in memory.
+        static std::unique_ptr<ChunkedMap> open(const std::string& path, int residentBudget);
+
+        ~ChunkedMap();
+
+        ChunkedMap(const ChunkedMap&) = delete;
+        ChunkedMap& operator=(const ChunkedMap&) = delete;
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        bool isInside(const int x, const int y) const
+        {
+            return x >= 0 && y >= 0 && x < width && y < height;
+        }
+
+        // The chunk holding a cell. Valid for any cell inside the map or within a chunk of its edge.
+        const Chunk& chunkAt(const int x, const int y) const
+        {
+            return *directory[static_cast<std::size_t>((y >> CHUNK_SHIFT) + 1) * directoryWidth + (x >> CHUNK_SHIFT) + 1];
+        }
+
+        // Cells in unloaded chunks read as walls, so movement stops at the edge of what is known.
+        bool isWall(const int x, const int y) const
+        {
+            return chunkAt(x, y).isWall(x & (CHUNK_SIZE - 1), y & (CHUNK_SIZE - 1));
+        }
+
+        // Returns the cell's material, or 0 when it is outside the map or not loaded.
+        int materialAt(int x, int y) const;
+
+        // Installs chunks the loader has finished, queues the ones the player will need next, and
+        // evicts the least recently needed ones over budget. Call between frames, never while casting.
+        // Returns true if any chunk became resident.
+        bool updateResidency(float x, float y, float dirX, float dirY);
+
+        // Increases whenever a chunk is installed or evicted, so cached results can tell when they are stale.
+        unsigned getRevision() const { return revision; }
+
+        int getResidentCount() const { return static_cast<int>(resident.size()); }
+
+    private:
+        ChunkedMap(std::ifstream file, int width, int height, int residentBudget);
+
+        void loaderLoop();
+        std::unique_ptr<Chunk> readChunk(int chunkX, int chunkY);
+
+        enum class ChunkState : std::uint8_t
+        {
+            OnDisk,
+            Queued,
+            Resident
+        };
+
+        struct ResidentChunk
+        {
+            std::unique_ptr<Chunk> chunk;
+            int index;
+        };
+
+        int width;
+        int height;
+        int chunksWide;
+        int chunksHigh;
+        int residentBudget;
+        unsigned revision{0};
+        std::uint64_t frame{0};
+
+        // Chunk pointers with a one chunk border, all pointing at the shared solid chunk until loaded.
+        int directoryWidth;
+        std::vector<const Chunk*> directory;
+        Chunk solid;
+
+        // Per chunk of the map, owned by the thread calling updateResidency.
+        std::vector<ChunkState> states;
+        std::vector<std::uint64_t> lastNeeded;
+        std::vector<std::uint64_t> retryFrames;
+        std::vector<std::uint8_t> readFailures;
+        std::vector<ResidentChunk> resident;
+
+        // Only read by the loader thread. A chunk that fails to read is handed back as null.
+        std::ifstream file;
+        std::thread loader;
+
+        // Shared with the loader thread.
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<int> queued;
+        std::vector<std::pair<int, std::unique_ptr<Chunk>>> loaded;
+        bool stopping{false};
+    };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "TextureAtlas.h"
+
+namespace rendering
+{
+    // Every palette colour pre-shaded at each light level, so a shaded pixel is one lookup rather than
+    // a multiply per channel. Each level is kept both packed in the framebuffer's format and as the
+    // nearest palette index, for indexed framebuffers. Level 0 is the darkest and the last level
+    // leaves colours unchanged.
+    class Colormap
+    {
+    public:
+        static constexpr int LIGHT_SHIFT = 5;
+        static constexpr int LIGHT_LEVELS = 1 << LIGHT_SHIFT;
+
+        // Brightness runs from 0 to 256, each light level covering an equal share of it.
+        static constexpr float LEVELS_PER_BRIGHTNESS = static_cast<float>(LIGHT_LEVELS) / 256.0f;
+
+        // packedPalette holds each palette colour packed in the framebuffer's format, and alphaMask its
+        // alpha bits.
+        Colormap(const Palette& palette, std::span<const std::uint32_t> packedPalette, std::uint32_t alphaMask);
+
+        // The shaded colours of one light level, indexed by palette index.
+        const std::uint32_t* level(const int light) const { return colours.data() + (light << 8); }
+
+        // The palette indices of one light level's shaded colours, indexed by palette index.
+        const std::uint8_t* indexLevel(const int light) const { return indices.data() + (light << 8); }
+
+    private:
+        std::vector<std::uint32_t> colours;
+        std::vector<std::uint8_t> indices;
+    };
+}
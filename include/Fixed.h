@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstdint>
+
+#include "Maths.h"
+
+namespace maths
+{
+    // Signed 16.16 fixed point. Every operation is integer arithmetic, so results are bit-identical
+    // regardless of compiler flags or FPU.
+    struct Fixed
+    {
+        static constexpr int FRACTION_BITS = 16;
+        static constexpr std::int32_t ONE = 1 << FRACTION_BITS;
+
+        std::int32_t raw{0};
+
+        constexpr Fixed() = default;
+
+        explicit constexpr Fixed(const int value) : raw(value * ONE) {}
+
+        explicit constexpr Fixed(const float value)
+            : raw(static_cast<std::int32_t>(value * ONE + (value < 0.0f ? -0.5f : 0.5f))) {}
+
+        static constexpr Fixed fromRaw(const std::int32_t raw)
+        {
+            Fixed value;
+            value.raw = raw;
+            return value;
+        }
+
+        explicit constexpr operator float() const { return static_cast<float>(raw) / ONE; }
+
+        // Arithmetic shift rounds towards negative infinity.
+        constexpr int floorToInt() const { return raw >> FRACTION_BITS; }
+
+        constexpr Fixed operator-() const { return fromRaw(-raw); }
+
+        constexpr Fixed& operator+=(const Fixed other) { raw += other.raw; return *this; }
+        constexpr Fixed& operator-=(const Fixed other) { raw -= other.raw; return *this; }
+
+        friend constexpr Fixed operator+(const Fixed a, const Fixed b) { return fromRaw(a.raw + b.raw); }
+        friend constexpr Fixed operator-(const Fixed a, const Fixed b) { return fromRaw(a.raw - b.raw); }
+
+        friend constexpr Fixed operator*(const Fixed a, const Fixed b)
+        {
+            return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(a.raw) * b.raw) >> FRACTION_BITS));
+        }
+
+        friend constexpr Fixed operator/(const Fixed a, const Fixed b)
+        {
+            return fromRaw(static_cast<std::int32_t>((static_cast<std::int64_t>(a.raw) << FRACTION_BITS) / b.raw));
+        }
+
+        friend constexpr auto operator<=>(Fixed a, Fixed b) = default;
+    };
+
+    constexpr int floorToInt(const Fixed value) { return value.floorToInt(); }
+
+    // Fixed point copies of the fine angle tables. Tangents are clamped to +/-TANGENT_LIMIT so that
+    // intercept steps along a map stay inside the 16.16 range.
+    struct FixedFineTables
+    {
+        FixedFineTables();
+
+        std::array<Fixed, FINE_ANGLES> sine;
+        std::array<Fixed, FINE_ANGLES> cosine;
+        std::array<Fixed, FINE_ANGLES> tangent;
+        std::array<Fixed, FINE_ANGLES> cotangent;
+
+        static constexpr int TANGENT_LIMIT = 1 << 14;
+    };
+
+    extern const FixedFineTables fixedFineTables;
+
+    inline Fixed fixedSin(const BinaryAngle angle) { return fixedFineTables.sine[toFineAngle(angle)]; }
+    inline Fixed fixedCos(const BinaryAngle angle) { return fixedFineTables.cosine[toFineAngle(angle)]; }
+    inline Fixed fixedTan(const BinaryAngle angle) { return fixedFineTables.tangent[toFineAngle(angle)]; }
+    inline Fixed fixedCot(const BinaryAngle angle) { return fixedFineTables.cotangent[toFineAngle(angle)]; }
+}
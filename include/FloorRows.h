@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Camera.h"
+#include "Colormap.h"
+#include "Framebuffer.h"
+#include "TextureAtlas.h"
+#include "WallColumns.h"
+
+namespace rendering
+{
+    // Where each screen row of floor lands in the world. A row of floor is all one distance away, so
+    // its world position moves by a constant step from column to column, found once per row here
+    // rather than per pixel. The ceiling row mirrored across the horizon sees the same distance, so
+    // the two share an entry.
+    //
+    // Entries are row pairs counted out from the horizon: pair i is the floor row
+    // screenHeight - size() + i and the ceiling row size() - 1 - i.
+    class FloorRows
+    {
+    public:
+        // Brightness of the floor and ceiling before fog, out of 256.
+        static constexpr int SHADE = 220;
+
+        int size() const { return static_cast<int>(lightLevels.size()); }
+
+        // The column offsets are the camera plane offset of each ray column, evenly spaced.
+        void project(const Camera& camera, float originX, float originY, std::span<const float> columnOffsets,
+                     const WallColumns::Projection& projection);
+
+        // The first pair nearer than the fog. The rows between it and the horizon are left to the fog.
+        int getFirstVisible() const { return firstVisible; }
+
+        // World position of the row's first column and its step per column, in texels.
+        std::span<const float> getStartX() const { return startX; }
+        std::span<const float> getStartY() const { return startY; }
+        std::span<const float> getStepX() const { return stepX; }
+        std::span<const float> getStepY() const { return stepY; }
+
+        // The row pair's colormap light level.
+        std::span<const std::uint8_t> getLightLevels() const { return lightLevels; }
+
+    private:
+        int firstVisible{0};
+
+        std::vector<float> startX;
+        std::vector<float> startY;
+        std::vector<float> stepX;
+        std::vector<float> stepY;
+        std::vector<std::uint8_t> lightLevels;
+    };
+
+    // Draws the textured floor and ceiling of every column between its wall and the fog, columnWidth
+    // pixels wide and shaded through the colormap. Meant to be drawn before the walls, which may cover
+    // a row or so of it.
+    void drawFloors(Framebuffer& framebuffer, const FloorRows& rows, const WallColumns& columns,
+                    const TextureAtlas& atlas, int floorMaterial, int ceilingMaterial,
+                    const Colormap& colormap, int columnWidth);
+    void drawFloors(IndexedFramebuffer& framebuffer, const FloorRows& rows, const WallColumns& columns,
+                    const TextureAtlas& atlas, int floorMaterial, int ceilingMaterial,
+                    const Colormap& colormap, int columnWidth);
+}
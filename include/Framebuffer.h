@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Raycaster.h"
+
+namespace rendering
+{
+    // A CPU-side image that passes write into directly, uploaded to the GPU once per frame. Pixel is a
+    // 32-bit colour packed in the texture's format, or an 8-bit palette index expanded on upload.
+    //
+    // Pixels are stored column-major, since walls and sprites are drawn a screen column at a time and
+    // a row-major column write would stride a whole row per pixel. Upload transposes the frame into
+    // the row-major layout textures use.
+    template <typename Pixel>
+    class BasicFramebuffer
+    {
+    public:
+        BasicFramebuffer(int width, int height);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        // Columns are height pixels apart with no padding.
+        std::span<const Pixel> getPixels() const { return pixels; }
+        std::span<Pixel> getPixels() { return pixels; }
+
+        Pixel* column(const int x) { return pixels.data() + static_cast<std::size_t>(x) * height; }
+
+        // Fills whole rows from firstRow up to, but not including, lastRow.
+        void fillRows(int firstRow, int lastRow, Pixel colour);
+
+        // Fills the columns from x up to x + columnWidth, between the same rows.
+        void fillColumns(int x, int columnWidth, int top, int bottom, Pixel colour);
+
+        // Writes the frame row-major into destination, whose rows are pitch bytes apart.
+        void copyRowMajor(void* destination, int pitch) const requires (sizeof(Pixel) == 4);
+
+        // Writes the frame row-major into destination as 32-bit colours, looking each index up in the
+        // palette on the way. The palette has an entry for every index, so no lookup needs a check.
+        // AVX2 gathers the lookups eight at a time. A kernel the CPU lacks falls back to the next best.
+        void expandRowMajor(void* destination, int pitch, std::span<const std::uint32_t, 256> palette,
+                            raycasting::Kernel kernel = raycasting::Kernel::Avx2) const
+            requires (sizeof(Pixel) == 1);
+
+    private:
+        int width;
+        int height;
+        std::vector<Pixel> pixels;
+    };
+
+    using Framebuffer = BasicFramebuffer<std::uint32_t>;
+
+    // A quarter of the memory traffic of a packed framebuffer in every pass, as the original game drew.
+    using IndexedFramebuffer = BasicFramebuffer<std::uint8_t>;
+}
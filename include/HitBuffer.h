@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Raycaster.h"
+
+namespace rendering
+{
+    // A frame's wall hits, one entry per column, with each field in its own contiguous array so a
+    // pass streams only the fields it reads. Sized once and reused every frame.
+    class HitBuffer
+    {
+    public:
+        // Reallocates only when the column count changed.
+        void resize(int columns);
+
+        int size() const { return static_cast<int>(distances.size()); }
+
+        // Fills the columns from first onwards from their hits. The directions are the rays' unit
+        // directions, and the cosines turn distances along them into perpendicular distances.
+        // Columns are independent, so chunks of them can be filled in parallel.
+        void store(int first, std::span<const raycasting::RayHit> hits, std::span<const float> dirX,
+                   std::span<const float> dirY, std::span<const float> cosines,
+                   float originX, float originY, const world::Map& map);
+
+        // Perpendicular distance to the wall, without the fisheye effect. Misses read FLT_MAX.
+        std::span<const float> getDistances() const { return distances; }
+
+        // 1 / perpendicular distance, which scales wall heights. Misses read 0.
+        std::span<const float> getInverseDistances() const { return inverseDistances; }
+
+        std::span<const raycasting::HitSide> getSides() const { return sides; }
+
+        // Row-major index of the hit cell in the map, or -1 for a miss.
+        std::span<const std::int32_t> getCells() const { return cells; }
+
+        // The hit cell's material, or 0 for a miss.
+        std::span<const std::uint8_t> getMaterials() const { return materials; }
+
+        // Where the ray struck the face, in [0, 1) from left to right as seen by the viewer.
+        std::span<const float> getTextureU() const { return textureU; }
+
+    private:
+        std::vector<float> distances;
+        std::vector<float> inverseDistances;
+        std::vector<raycasting::HitSide> sides;
+        std::vector<std::int32_t> cells;
+        std::vector<std::uint8_t> materials;
+        std::vector<float> textureU;
+    };
+}
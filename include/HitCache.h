@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "Maths.h"
+#include "Raycaster.h"
+
+namespace raycasting
+{
+    // Hits keyed by absolute fine angle, valid for a single origin and map revision. Rays are cast
+    // along fine angles, so a rotation by multiples of the column table's angle step re-casts only
+    // the angles that weren't in view before.
+    class HitCache
+    {
+    public:
+        HitCache();
+
+        // Invalidates every entry when the origin or the map changed since the entries were cast.
+        void prepare(float originX, float originY, unsigned mapRevision);
+
+        // Returns the cached hit for the angle, or nullptr if it hasn't been cast from this origin.
+        const RayHit* find(const maths::BinaryAngle angle) const
+        {
+            const int index = maths::toFineAngle(angle);
+            return stamps[index] == generation ? &hits[index] : nullptr;
+        }
+
+        void store(const maths::BinaryAngle angle, const RayHit& hit)
+        {
+            const int index = maths::toFineAngle(angle);
+            hits[index] = hit;
+            stamps[index] = generation;
+        }
+
+    private:
+        std::vector<RayHit> hits;
+
+        // An entry is valid when its stamp matches the current generation, so invalidating the cache
+        // is a single increment rather than a clear.
+        std::vector<unsigned> stamps;
+        unsigned generation{1};
+
+        float originX{0.0f};
+        float originY{0.0f};
+        unsigned mapRevision{0};
+    };
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace world
+{
+    // The material byte stored for a cell value. Any non-zero value is a wall, so it is clamped into
+    // 1 to 255.
+    std::uint8_t toMaterial(int value);
+
+    // Occupancy, wall distances and materials are kept in separate planes. The occupancy and distance
+    // planes carry a one cell border of sentinel walls, so a walk that stops at walls never needs a
+    // bounds check; reaching the border means the ray has left the map.
+    class Map
+    {
+    public:
+        // Wall distances are capped here, which also bounds the area a cell change has to update.
+        static constexpr int MAX_WALL_DISTANCE = 64;
+
+        // Any non-zero cell is a wall, with the material toMaterial gives it.
+        Map(int width, int height, const std::vector<int>& cells);
+
+        int getWidth() const { return width; }
+        int getHeight() const { return height; }
+
+        bool isInside(const int x, const int y) const
+        {
+            return x >= 0 && y >= 0 && x < width && y < height;
+        }
+
+        // Cells in the sentinel border read as walls. The cell must be inside the map or its border.
+        bool isWall(const int x, const int y) const
+        {
+            const int paddedX = x + 1;
+            return (rowBits[static_cast<std::size_t>(y + 1) * rowWords + (paddedX >> 6)] >> (paddedX & 63) & 1) != 0;
+        }
+
+        // Returns the cell's material, or 0 for cells outside of the map. Only needed once a ray has hit.
+        int materialAt(int x, int y) const;
+
+        // Changes a cell inside the map and bumps the revision. Cells outside the map are ignored, and the
+        // value goes through toMaterial like the constructor's.
+        void setCell(int x, int y, int value);
+
+        // Increases whenever a cell changes, so cached results can tell when they are stale.
+        unsigned getRevision() const { return revision; }
+
+        // Chebyshev distance from the cell to the nearest wall, capped at MAX_WALL_DISTANCE. Every cell
+        // closer to it than this is empty. Walls and the sentinel border read 0. The cell must be inside
+        // the map or its border.
+        int wallDistance(const int x, const int y) const
+        {
+            return wallDistances[paddedIndex(x, y)];
+        }
+
+        // The mean wall distance over the map's empty cells, or 0 when it has none. Kept up to date by
+        // setCell, so walks can tell whether jumping across empty space will pay.
+        float getMeanWallDistance() const { return meanWallDistance; }
+
+        // The first wall along the cell's row or column in the step direction, found a 64-bit word at a
+        // time. Returns the border column or row when the map ends first.
+        int findWallInRow(int x, int y, int step) const;
+        int findWallInColumn(int x, int y, int step) const;
+
+        // The distance plane from cell (0, 0), with rows getStride() bytes apart. It is readable from
+        // the border around the map, plus three bytes past it so 32-bit gathers can load any cell.
+        const std::uint8_t* wallDistanceData() const { return wallDistances.data() + paddedIndex(0, 0); }
+        int getStride() const { return stride; }
+
+    private:
+        std::size_t paddedIndex(const int x, const int y) const
+        {
+            return static_cast<std::size_t>(y + 1) * stride + (x + 1);
+        }
+
+        void setWallBit(int paddedX, int paddedY, bool isWall);
+        void updateWallDistances(int minX, int minY, int maxX, int maxY);
+
+        int width;
+        int height;
+        unsigned revision{0};
+
+        // Row length of the padded byte planes, and 64-bit words per padded row and column.
+        int stride;
+        int rowWords;
+        int columnWords;
+
+        // One bit per padded cell, row-major and column-major, so scans along either axis read words.
+        std::vector<std::uint64_t> rowBits;
+        std::vector<std::uint64_t> columnBits;
+
+        std::vector<std::uint8_t> wallDistances;
+        std::vector<std::uint8_t> materials;
+
+        // Wall distances summed over the cells inside the map, and how many of them are empty.
+        std::uint64_t wallDistanceTotal{0};
+        int emptyCells{0};
+        float meanWallDistance{0.0f};
+    };
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+
 namespace maths
 {
     float degreesToRadians( float degrees);
@@ -8,4 +11,44 @@ namespace maths
     float normaliseAngle(float angle);
 
     float distanceBetween(float x1, float y1, float x2, float y2);
-}
\ No newline at end of file
+
+    int floorToInt(float value);
+
+    // Binary angle measurement: a full turn is 65536 units, so unsigned overflow wraps the angle.
+    using BinaryAngle = std::uint16_t;
+
+    constexpr int BINARY_ANGLES = 65536;
+
+    // Wolf3D-style fine angles. The lookup tables hold one entry per fine angle. Columns at the edges
+    // of a 90 degree FOV are closest together, about 0.015 degrees apart at 4K, so a fine angle is a
+    // whole binary angle (0.0055 degrees) to keep every column there on an angle of its own.
+    constexpr int FINE_ANGLE_BITS = 16;
+    constexpr int FINE_ANGLES = 1 << FINE_ANGLE_BITS;
+    constexpr int FINE_ANGLE_SHIFT = 16 - FINE_ANGLE_BITS;
+
+    BinaryAngle radiansToBinaryAngle(float radians);
+    float binaryAngleToRadians(BinaryAngle angle);
+
+    constexpr int toFineAngle(const BinaryAngle angle) { return angle >> FINE_ANGLE_SHIFT; }
+
+    struct FineTables
+    {
+        FineTables();
+
+        std::array<float, FINE_ANGLES> sine;
+        std::array<float, FINE_ANGLES> cosine;
+
+        // Clamped to +/-TANGENT_LIMIT where the true value is infinite.
+        std::array<float, FINE_ANGLES> tangent;
+        std::array<float, FINE_ANGLES> cotangent;
+
+        static constexpr float TANGENT_LIMIT = 1e6f;
+    };
+
+    extern const FineTables fineTables;
+
+    inline float fineSin(const BinaryAngle angle) { return fineTables.sine[toFineAngle(angle)]; }
+    inline float fineCos(const BinaryAngle angle) { return fineTables.cosine[toFineAngle(angle)]; }
+    inline float fineTan(const BinaryAngle angle) { return fineTables.tangent[toFineAngle(angle)]; }
+    inline float fineCot(const BinaryAngle angle) { return fineTables.cotangent[toFineAngle(angle)]; }
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "Fixed.h"
+#include "Map.h"
+#include "Maths.h"
+
+namespace util
+{
+    class ThreadPool;
+}
+
+namespace world
+{
+    class ChunkedMap;
+}
+
+namespace raycasting
+{
+    // Which set of grid lines the ray crossed to reach the wall.
+    enum class HitSide : std::uint8_t
+    {
+        None,
+        Horizontal,
+        Vertical
+    };
+
+    struct RayHit
+    {
+        // Distance along the ray direction, in multiples of the direction's length.
+        float distance;
+        int cellX;
+        int cellY;
+        HitSide side;
+    };
+
+    // Result of the fixed point caster, in the same layout as RayHit.
+    struct FixedRayHit
+    {
+        maths::Fixed distance;
+        int cellX;
+        int cellY;
+        HitSide side;
+    };
+
+    // The face of the hit cell that the ray entered through. North is towards -Y.
+    enum class Face : std::uint8_t
+    {
+        None,
+        North,
+        South,
+        West,
+        East
+    };
+
+    // A standalone ray for gameplay queries such as AI sight lines, hitscan and audio occlusion.
+    struct RayQuery
+    {
+        float originX;
+        float originY;
+        float dirX;
+        float dirY;
+
+        // In multiples of the direction's length, like the returned distance.
+        float maxDistance;
+    };
+
+    struct QueryHit
+    {
+        // Whether a wall was found within the query's maximum distance.
+        bool hit;
+        float distance;
+        int cellX;
+        int cellY;
+        Face face;
+        float hitX;
+        float hitY;
+    };
+
+    // Instruction set used when casting several rays at once.
+    enum class Kernel : std::uint8_t
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    // Grid traversal using a single DDA walk: one step per cell crossed, with no depth cap.
+    // The walk ends at the first wall cell or when the ray leaves the map.
+    class Raycaster
+    {
+    public:
+        // cast() jumps across the empty space the distance field guarantees only on maps whose empty
+        // cells lie at least this far from a wall on average. On denser maps the jumps are too short
+        // to pay for their reads, and it tests the occupancy bits a cell at a time.
+        static constexpr float MIN_MEAN_WALL_DISTANCE_TO_JUMP = 12.0f;
+
+        explicit Raycaster(const world::Map& map);
+
+        // A ray that would need to pass maxDistance to reach the next grid line stops as a miss.
+        RayHit cast(float originX, float originY, float dirX, float dirY,
+                    float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Resolves a batch of independent queries into results of the same size. With a thread
+        // pool, the batch is split into chunks that are cast in parallel, unless it is called from
+        // one of that pool's jobs, where the chunks are cast serially on the job's thread.
+        void castQueries(std::span<const RayQuery> queries, std::span<QueryHit> results) const;
+        void castQueries(std::span<const RayQuery> queries, std::span<QueryHit> results, util::ThreadPool& pool) const;
+
+        // Deterministic 16.16 fixed point walk along a fine angle, stepping the x and y intercepts
+        // by the tabled tangent and cotangent. Produces identical results on every platform. A hit
+        // further than maxDistance is a miss, and the walk gives up once no closer hit is possible.
+        FixedRayHit castFixed(maths::Fixed originX, maths::Fixed originY, maths::BinaryAngle angle,
+                              maths::Fixed maxDistance = maths::Fixed::fromRaw(std::numeric_limits<std::int32_t>::max())) const;
+
+        // Casts one ray per direction from a shared origin using the selected kernel.
+        // Every kernel produces exactly the same hits as cast() with the same maxDistance.
+        void castRays(float originX, float originY, std::span<const float> dirX, std::span<const float> dirY,
+                      std::span<RayHit> hits, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Casts a fan of neighbouring directions (sorted by angle) by casting only the ends of spans of
+        // at most maxSpan rays. When both ends hit the same face of the same cell, the rays between
+        // them are intersected with that face directly; otherwise the span is split in half.
+        // An occluder narrow enough to fit between two span ends can be missed, so maxSpan trades
+        // walk savings against how small a gap in the fan may be.
+        void castRaysCoherent(float originX, float originY, std::span<const float> dirX, std::span<const float> dirY,
+                              std::span<RayHit> hits, int maxSpan,
+                              float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        Kernel getKernel() const { return kernel; }
+
+        // Falls back to the next best kernel when the CPU does not support the requested one.
+        void setKernel(Kernel kernel);
+
+    private:
+        void fillSpan(float originX, float originY, std::span<const float> dirX, std::span<const float> dirY,
+                      std::span<RayHit> hits, int first, int last, float maxDistance) const;
+
+        const world::Map& map;
+        Kernel kernel;
+    };
+
+    // The same DDA walk over a streamed map, producing the hits Raycaster::cast would on the whole map.
+    // It only consults the chunk directory when it crosses into another chunk. A chunk still on disk
+    // stops the ray like a wall but reports a miss.
+    class ChunkedRaycaster
+    {
+    public:
+        explicit ChunkedRaycaster(const world::ChunkedMap& map);
+
+        RayHit cast(float originX, float originY, float dirX, float dirY,
+                    float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        void castRays(float originX, float originY, std::span<const float> dirX, std::span<const float> dirY,
+                      std::span<RayHit> hits) const;
+
+    private:
+        const world::ChunkedMap& map;
+    };
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Map.h"
+#include "Raycaster.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RAYCASTER_X86 1
+#endif
+
+// Packet kernels behind Raycaster::castRays. Each advances one ray per lane in lockstep from a
+// shared origin, retiring lanes as they hit a wall or leave the map, and produces bit-identical
+// results to Raycaster::cast.
+namespace raycasting::simd
+{
+    bool isSupported(Kernel kernel);
+
+    void castSse2(const world::Map& map, float originX, float originY,
+                  const float* dirX, const float* dirY, int count, RayHit* hits, float maxDistance);
+
+    void castAvx2(const world::Map& map, float originX, float originY,
+                  const float* dirX, const float* dirY, int count, RayHit* hits, float maxDistance);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+namespace rendering
+{
+    // A resolution the frame can be drawn at: the width drawn before it's scaled to the screen, and
+    // how many of those pixel columns each ray covers.
+    struct RenderResolution
+    {
+        int width;
+        int rayRes;
+
+        bool operator==(const RenderResolution&) const = default;
+    };
+
+    // Holds a frame time target by stepping through resolutions ordered from the sharpest to the
+    // cheapest. Frame times are averaged, and a step is only taken once the average leaves a band
+    // around the target and the last step has had time to show in it, so the resolution settles
+    // rather than flickering between two steps.
+    class ResolutionScaler
+    {
+    public:
+        // Frames averaged after a step before the next can be taken.
+        static constexpr int SETTLE_FRAMES = 30;
+
+        // An average above this fraction of the target steps down, and below this one steps up. The
+        // gap is wider than the cost of one step, so stepping up doesn't immediately overshoot.
+        static constexpr double STEP_DOWN_FRACTION = 1.05;
+        static constexpr double STEP_UP_FRACTION = 0.6;
+
+        // Starts at the sharpest resolution.
+        ResolutionScaler(std::span<const RenderResolution> resolutions, double targetSeconds);
+
+        // Takes the time of one drawn frame. Returns true when the resolution changed.
+        bool update(double frameSeconds);
+
+        const RenderResolution& getResolution() const { return resolutions[step]; }
+        double getTarget() const { return targetSeconds; }
+
+    private:
+        std::vector<RenderResolution> resolutions;
+        double targetSeconds;
+
+        int step{0};
+        int frames{0};
+        double averageSeconds{0.0};
+    };
+}
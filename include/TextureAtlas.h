@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rendering
+{
+    struct Colour
+    {
+        std::uint8_t r;
+        std::uint8_t g;
+        std::uint8_t b;
+    };
+
+    using Palette = std::array<Colour, 256>;
+
+    // Square textures of palette indices in one block of memory. Each is stored column-major,
+    // so drawing a screen column reads one contiguous texture column.
+    class TextureAtlas
+    {
+    public:
+        static constexpr int TEXTURE_SHIFT = 6;
+        static constexpr int TEXTURE_SIZE = 1 << TEXTURE_SHIFT;
+
+        // Adds a texture given row by row, as images are stored, transposing it on the way in.
+        // Returns its index.
+        int add(std::span<const std::uint8_t> rows);
+
+        int getCount() const { return static_cast<int>(texels.size() >> (2 * TEXTURE_SHIFT)); }
+
+        // Where a material's texture starts in getTexels(). Material 1 uses the first texture, and
+        // materials past the last texture wrap around.
+        int textureOffset(int material) const;
+
+        // Where a wall's texture column starts in getTexels(). u is in [0, 1).
+        int columnOffset(int material, float u) const;
+
+        std::span<const std::uint8_t> getTexels() const { return texels; }
+
+    private:
+        std::vector<std::uint8_t> texels;
+    };
+
+    // The built-in palette, four 64 shade ramps from black to full colour, and the wall textures drawn
+    // with it: brick, stone blocks, tiles and wooden planks.
+    Palette createDefaultPalette();
+    TextureAtlas createDefaultTextures();
+
+    // The index of the palette colour closest to colour.
+    std::uint8_t nearestColour(const Palette& palette, Colour colour);
+}
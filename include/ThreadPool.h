@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+    // Persistent workers that split a job into chunks. run() is the only synchronisation point:
+    // it hands the job to the workers, helps out on the calling thread and returns once every
+    // chunk has finished.
+    class ThreadPool
+    {
+    public:
+        // A thread count of 0 uses one thread per hardware core.
+        explicit ThreadPool(unsigned threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Number of threads taking part in run(), including the caller.
+        unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+        void setThreadCount(unsigned threadCount);
+
+        // A job may call run() on the same pool, and the nested chunks then run serially on its
+        // thread. Calls from two threads outside the pool must not overlap.
+        void run(int chunkCount, const std::function<void(int chunk)>& job);
+
+    private:
+        void start(unsigned threadCount);
+        void stop();
+
+        void workerLoop();
+        void runChunks();
+
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable finished;
+
+        const std::function<void(int)>* job{nullptr};
+        int chunkCount{0};
+        int nextChunk{0};
+        int chunksDone{0};
+        unsigned generation{0};
+        bool stopping{false};
+    };
+}
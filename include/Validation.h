@@ -0,0 +1,61 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Map.h"
+#include "Maths.h"
+#include "Raycaster.h"
+
+namespace raycasting::validation
+{
+    // A wall hit found in double precision, by intersecting the ray with every vertical grid line
+    // and every horizontal one in turn and keeping the nearer wall.
+    struct ReferenceHit
+    {
+        double distance;
+        int cellX;
+        int cellY;
+        HitSide side;
+    };
+
+    ReferenceHit castReference(const world::Map& map, double originX, double originY, double dirX, double dirY);
+
+    // How far one caster strayed from the reference. Distances are only compared where both hit a wall.
+    struct CasterReport
+    {
+        std::string caster;
+        long rays{0};
+
+        // Rays where one found a wall and the other didn't, or they hit different cells or sides of
+        // the same cell.
+        long wrongHits{0};
+        long wrongCells{0};
+        long wrongSides{0};
+
+        double maxDistanceError{0.0};
+        double meanDistanceError{0.0};
+
+        // The most the caster may stray before it fails: mismatched rays per million, and error in a
+        // hit's distance. Approximate casters are reported but never fail.
+        double allowedMismatchesPerMillion{0.0};
+        double allowedDistanceError{0.0};
+        bool isExact{true};
+
+        bool isAccurate() const;
+    };
+
+    // Seeded maps of varied size and density, with and without a solid border.
+    std::vector<world::Map> makeMaps(unsigned seed);
+
+    // Casts every column for posesPerMap seeded camera poses on each map with every caster, and
+    // compares each hit with the reference.
+    std::vector<CasterReport> run(const std::vector<world::Map>& maps, std::span<const maths::BinaryAngle> columnAngles,
+                                  int posesPerMap, unsigned seed);
+
+    // Writes a seeded map to a chunked file at path and streams it back, checking its cells, its casts
+    // against Raycaster::cast, its eviction under a small budget, and that chunks which failed to read
+    // are retried once the file is whole. Removes the file afterwards. Returns one line per failure.
+    std::vector<std::string> checkChunkedMap(const std::string& path, unsigned seed);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Colormap.h"
+#include "Framebuffer.h"
+#include "HitBuffer.h"
+#include "TextureAtlas.h"
+
+namespace rendering
+{
+    // What the rasterizer needs to draw each column's wall: the screen rows it covers, its light and
+    // where its texture column starts and steps. Projected from a HitBuffer in one vectorized pass,
+    // so drawing does no per-column maths.
+    class WallColumns
+    {
+    public:
+        // Brightness of each side before fog, out of 256, so corners stay visible.
+        static constexpr int HORIZONTAL_SHADE = 255;
+        static constexpr int VERTICAL_SHADE = 180;
+
+        struct Projection
+        {
+            int screenHeight;
+
+            // A wall's height on screen is this divided by its perpendicular distance.
+            float heightScale;
+
+            // Walls fade out towards the fog distance, and those past it aren't drawn.
+            float fogDistance;
+        };
+
+        // Reallocates only when the column count changed.
+        void resize(int columns);
+
+        int size() const { return static_cast<int>(tops.size()); }
+
+        void project(const HitBuffer& hits, const Projection& projection, const TextureAtlas& atlas);
+
+        // First row covered and the row after the last, clipped to the screen. Equal for columns
+        // with no wall to draw.
+        std::span<const std::int16_t> getTops() const { return tops; }
+        std::span<const std::int16_t> getBottoms() const { return bottoms; }
+
+        // The column's colormap light level.
+        std::span<const std::uint8_t> getLightLevels() const { return lightLevels; }
+
+        // Start of the column's texture column in the atlas' texels.
+        std::span<const std::int32_t> getTexelColumns() const { return texelColumns; }
+
+        // Texture V at the centre of the top row and its step per row, in 16.16 texels.
+        std::span<const std::uint32_t> getTextureV() const { return textureV; }
+        std::span<const std::uint32_t> getTextureVSteps() const { return textureVSteps; }
+
+    private:
+        std::vector<std::int16_t> tops;
+        std::vector<std::int16_t> bottoms;
+        std::vector<std::uint8_t> lightLevels;
+        std::vector<std::int32_t> texelColumns;
+        std::vector<std::uint32_t> textureV;
+        std::vector<std::uint32_t> textureVSteps;
+    };
+
+    // Draws every column's textured wall into the framebuffer, columnWidth pixels wide, shaded through
+    // the colormap.
+    void drawWalls(Framebuffer& framebuffer, const WallColumns& columns, const TextureAtlas& atlas,
+                   const Colormap& colormap, int columnWidth);
+    void drawWalls(IndexedFramebuffer& framebuffer, const WallColumns& columns, const TextureAtlas& atlas,
+                   const Colormap& colormap, int columnWidth);
+}
@@ -0,0 +1,997 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <numbers>
+#include <random>
+
+#include "Camera.h"
+#include "Colormap.h"
+#include "Framebuffer.h"
+#include "HitBuffer.h"
+#include "HitCache.h"
+#include "Maths.h"
+#include "Raycaster.h"
+#include "RaycasterSimd.h"
+#include "TextureAtlas.h"
+#include "WallColumns.h"
+
+namespace benchmark
+{
+    namespace
+    {
+        // A batch runs the job until it has taken at least this long, and the best of the batches counts.
+        constexpr double BATCH_MICROSECONDS = 20000.0;
+        constexpr int BATCHES = 5;
+
+        volatile float sink;
+
+        std::string format(const char* pattern, const double value)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), pattern, value);
+            return text;
+        }
+
+        struct Pose
+        {
+            float x;
+            float y;
+            maths::BinaryAngle angle;
+        };
+
+        // Seeded camera poses somewhere inside the empty cells of the map.
+        std::vector<Pose> makePoses(const world::Map& map, const int count, const unsigned seed)
+        {
+            std::mt19937 random(seed);
+            std::uniform_real_distribution<float> within(0.05f, 0.95f);
+            std::vector<Pose> poses;
+
+            while (static_cast<int>(poses.size()) < count)
+            {
+                const int x = static_cast<int>(random() % map.getWidth());
+                const int y = static_cast<int>(random() % map.getHeight());
+
+                if (!map.isWall(x, y))
+                    poses.push_back({x + within(random), y + within(random), static_cast<maths::BinaryAngle>(random())});
+            }
+
+            return poses;
+        }
+
+        // A map walled in on every side, with about one cell in wallOneIn a wall inside, or none for 0.
+        world::Map makeRoom(const int width, const int height, const int wallOneIn, std::mt19937& random)
+        {
+            std::vector<int> cells(static_cast<std::size_t>(width) * height, 0);
+
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    const bool isBorder = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+
+                    if (isBorder || (wallOneIn > 0 && random() % wallOneIn == 0))
+                        cells[static_cast<std::size_t>(y) * width + x] = 1 + static_cast<int>(random() % 3);
+                }
+            }
+
+            return {width, height, cells};
+        }
+
+        struct NamedMap
+        {
+            std::string name;
+            world::Map map;
+        };
+
+        struct TwoLoopCast
+        {
+            int probes;
+            bool isHit;
+        };
+
+        // The caster the DDA walk replaced: a loop across horizontal grid lines and then one across
+        // vertical lines, each probing the cell past up to 20 lines along a radian angle. Cells are
+        // bounds checked here, where the original compared tileX + tileY against the map's size.
+        TwoLoopCast castTwoLoops(const world::Map& map, const float x, const float y, const float angle)
+        {
+            constexpr int MAXIMUM_DEPTH = 20;
+            constexpr float PI = std::numbers::pi_v<float>;
+
+            const auto hasWallAt = [&](const float worldX, const float worldY)
+            {
+                if (!(worldX >= 0.0f && worldY >= 0.0f && worldX < map.getWidth() && worldY < map.getHeight()))
+                    return false;
+
+                return map.isWall(static_cast<int>(worldX), static_cast<int>(worldY));
+            };
+
+            TwoLoopCast result{0, false};
+
+            const auto probe = [&](float rayX, float rayY, const float stepX, const float stepY)
+            {
+                for (int depth = 0; depth < MAXIMUM_DEPTH; depth++, rayX += stepX, rayY += stepY)
+                {
+                    result.probes++;
+
+                    if (hasWallAt(rayX, rayY))
+                    {
+                        result.isHit = true;
+                        return;
+                    }
+                }
+            };
+
+            const float tangent = std::tan(angle);
+            const bool isFacingUp = angle > PI;
+            const bool isFacingLeft = angle > 0.5f * PI && angle < 1.5f * PI;
+
+            const float horizontalY = isFacingUp ? std::floor(y) - 0.000001f : std::floor(y) + 1.0f;
+            const float horizontalStep = isFacingUp ? -1.0f : 1.0f;
+            probe((horizontalY - y) / tangent + x, horizontalY, horizontalStep / tangent, horizontalStep);
+
+            const float verticalX = isFacingLeft ? std::floor(x) - 0.000001f : std::floor(x) + 1.0f;
+            const float verticalStep = isFacingLeft ? -1.0f : 1.0f;
+            probe(verticalX, y + (verticalX - x) * tangent, verticalStep, verticalStep * tangent);
+
+            return result;
+        }
+
+        // The scalar walk before the distance field: a cell per step, each tested in the occupancy bits.
+        // Side distances are recomputed from the origin as cast() does, so the hits match it exactly.
+        // Kept out of line like cast(), so the timings compare the walks rather than the call.
+        [[gnu::noinline]] raycasting::RayHit castPerCell(const world::Map& map, const float originX, const float originY,
+                                       const float dirX, const float dirY,
+                                       const float maxDistance = std::numeric_limits<float>::infinity())
+        {
+            const raycasting::RayHit miss{std::numeric_limits<float>::max(), -1, -1, raycasting::HitSide::None};
+
+            int cellX = static_cast<int>(std::floor(originX));
+            int cellY = static_cast<int>(std::floor(originY));
+
+            if (!map.isInside(cellX, cellY))
+                return miss;
+
+            const int stepX = dirX < 0.0f ? -1 : 1;
+            const int stepY = dirY < 0.0f ? -1 : 1;
+            const float invDirX = dirX != 0.0f ? 1.0f / dirX : 1e30f;
+            const float invDirY = dirY != 0.0f ? 1.0f / dirY : 1e30f;
+            const int edgeX = stepX > 0 ? 1 : 0;
+            const int edgeY = stepY > 0 ? 1 : 0;
+
+            float sideDistX = (static_cast<float>(cellX + edgeX) - originX) * invDirX;
+            float sideDistY = (static_cast<float>(cellY + edgeY) - originY) * invDirY;
+
+            while (true)
+            {
+                if (std::min(sideDistX, sideDistY) > maxDistance)
+                    return miss;
+
+                if (sideDistX < sideDistY)
+                {
+                    cellX += stepX;
+
+                    if (map.isWall(cellX, cellY))
+                        return map.isInside(cellX, cellY) ? raycasting::RayHit{sideDistX, cellX, cellY, raycasting::HitSide::Vertical} : miss;
+
+                    sideDistX = (static_cast<float>(cellX + edgeX) - originX) * invDirX;
+                }
+                else
+                {
+                    cellY += stepY;
+
+                    if (map.isWall(cellX, cellY))
+                        return map.isInside(cellX, cellY) ? raycasting::RayHit{sideDistY, cellX, cellY, raycasting::HitSide::Horizontal} : miss;
+
+                    sideDistY = (static_cast<float>(cellY + edgeY) - originY) * invDirY;
+                }
+            }
+        }
+
+        bool isSameHit(const raycasting::RayHit& a, const raycasting::RayHit& b)
+        {
+            if (a.side == raycasting::HitSide::None || b.side == raycasting::HitSide::None)
+                return a.side == b.side;
+
+            return a.side == b.side && a.cellX == b.cellX && a.cellY == b.cellY && a.distance == b.distance;
+        }
+
+        // drawWalls as it was for a row-major framebuffer, a whole row apart per pixel.
+        void drawWallsRowMajor(std::vector<std::uint32_t>& pixels, const int width, const rendering::WallColumns& columns,
+                               const rendering::TextureAtlas& atlas, const rendering::Colormap& colormap)
+        {
+            const std::uint8_t* texels = atlas.getTexels().data();
+
+            for (int x = 0; x < columns.size(); x++)
+            {
+                const int top = columns.getTops()[x];
+                const int bottom = columns.getBottoms()[x];
+
+                const std::uint8_t* texelColumn = texels + columns.getTexelColumns()[x];
+                const std::uint32_t* shaded = colormap.level(columns.getLightLevels()[x]);
+                const std::uint32_t vStep = columns.getTextureVSteps()[x];
+                std::uint32_t v = columns.getTextureV()[x];
+
+                for (int y = top; y < bottom; y++, v += vStep)
+                    pixels[static_cast<std::size_t>(y) * width + x] = shaded[texelColumn[(v >> 16) & (rendering::TextureAtlas::TEXTURE_SIZE - 1)]];
+            }
+        }
+    }
+
+    double timeMicroseconds(const std::function<void()>& job)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double best = 0.0;
+
+        for (int batch = 0; batch < BATCHES; batch++)
+        {
+            const Clock::time_point start = Clock::now();
+            double elapsed = 0.0;
+            long runs = 0;
+
+            while (elapsed < BATCH_MICROSECONDS)
+            {
+                job();
+                runs++;
+                elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            }
+
+            const double perRun = elapsed / static_cast<double>(runs);
+            best = batch == 0 ? perRun : std::min(best, perRun);
+        }
+
+        return best;
+    }
+
+    void consume(const float value)
+    {
+        sink = sink + value;
+    }
+
+    std::vector<Table> rayDirections(const world::Map& map, const float hfov, const unsigned seed)
+    {
+        constexpr int POSES = 2000;
+
+        Table timings{"ray directions per frame (us)", {"columns", "atan2+sin+cos", "camera plane", "fine tables"}, {}};
+        Table errors{"fine-angle wall rays against camera-plane rays, " + std::to_string(POSES) + " poses",
+                     {"columns", "duplicated", "max snap (columns)", "other cell", "mean |err|", "max |err|"}, {}};
+
+        const raycasting::Raycaster raycaster{map};
+        const std::vector<Pose> poses = makePoses(map, POSES, seed);
+        const maths::BinaryAngle heading = maths::BINARY_ANGLES / 8;
+
+        for (const int columns : {160, 1920, 3840, 7680})
+        {
+            rendering::ColumnTable columnTable;
+            columnTable.rebuild(columns, 1, hfov);
+
+            const std::span<const float> offsets = columnTable.getOffsets();
+            const std::span<const float> cosines = columnTable.getCosines();
+            const std::span<const maths::BinaryAngle> angles = columnTable.getAngles();
+            const float planeScale = columnTable.getPlaneScale();
+
+            // How far each column's fine angle sits from its exact angle on the camera plane, against the
+            // gap to the next column's exact angle. The tables are looked up at heading plus column angle.
+            const auto fineAngle = [&](const int i)
+            {
+                const auto angle = static_cast<maths::BinaryAngle>(heading + angles[i]);
+                return maths::toFineAngle(angle);
+            };
+
+            int duplicated = 0;
+            double maxSnap = 0.0;
+
+            for (int i = 0; i < columns; i++)
+            {
+                const double exact = std::atan(static_cast<double>(offsets[i]) * planeScale);
+                const double next = std::atan(static_cast<double>(offsets[std::min(i + 1, columns - 1)]) * planeScale);
+                const double previous = std::atan(static_cast<double>(offsets[std::max(i - 1, 0)]) * planeScale);
+                const double spacing = (next - previous) / (i == 0 || i == columns - 1 ? 1.0 : 2.0);
+                const double snapped = std::remainder(
+                    fineAngle(i) * (2.0 * std::numbers::pi / maths::FINE_ANGLES) - maths::binaryAngleToRadians(heading),
+                    2.0 * std::numbers::pi);
+
+                maxSnap = std::max(maxSnap, std::abs(snapped - exact) / spacing);
+                duplicated += i > 0 && fineAngle(i) == fineAngle(i - 1) ? 1 : 0;
+            }
+
+            std::vector<float> dirX(columns);
+            std::vector<float> dirY(columns);
+
+            // The direction loops only, without casting, as each was generated per frame.
+            if (columns == 160 || columns == 3840)
+            {
+                const float headingRadians = maths::binaryAngleToRadians(heading);
+                const float maxX = static_cast<float>(columns - 1);
+                const float distanceToPlane = columns * 0.5f / planeScale;
+
+                const double trig = timeMicroseconds([&]
+                {
+                    for (int i = 0; i < columns; i++)
+                    {
+                        const float screenX = (static_cast<float>(i * 2) - maxX) / maxX * columns * 0.5f;
+                        const float angle = headingRadians + std::atan2(screenX, distanceToPlane);
+                        dirX[i] = std::cos(angle);
+                        dirY[i] = std::sin(angle);
+                    }
+
+                    consume(dirX[columns / 2] + dirY[columns - 1]);
+                });
+
+                const double plane = timeMicroseconds([&]
+                {
+                    const rendering::Camera camera = rendering::Camera::fromAngle(heading, planeScale);
+
+                    for (int i = 0; i < columns; i++)
+                    {
+                        dirX[i] = (camera.dirX + camera.planeX * offsets[i]) * cosines[i];
+                        dirY[i] = (camera.dirY + camera.planeY * offsets[i]) * cosines[i];
+                    }
+
+                    consume(dirX[columns / 2] + dirY[columns - 1]);
+                });
+
+                const double fine = timeMicroseconds([&]
+                {
+                    for (int i = 0; i < columns; i++)
+                    {
+                        const auto angle = static_cast<maths::BinaryAngle>(heading + angles[i]);
+                        dirX[i] = maths::fineCos(angle);
+                        dirY[i] = maths::fineSin(angle);
+                    }
+
+                    consume(dirX[columns / 2] + dirY[columns - 1]);
+                });
+
+                timings.rows.push_back({std::to_string(columns), format("%.2f", trig), format("%.2f", plane),
+                                        format("%.2f", fine)});
+            }
+
+            // Perpendicular distances of the walls each kind of ray finds, over every column of every pose.
+            long otherCells = 0;
+            long compared = 0;
+            double errorTotal = 0.0;
+            double maxError = 0.0;
+
+            if (columns <= 3840)
+            {
+                for (const Pose& pose : poses)
+                {
+                    const rendering::Camera camera = rendering::Camera::fromAngle(pose.angle, planeScale);
+
+                    for (int i = 0; i < columns; i++)
+                    {
+                        const auto angle = static_cast<maths::BinaryAngle>(pose.angle + angles[i]);
+                        const raycasting::RayHit fine = raycaster.cast(pose.x, pose.y, maths::fineCos(angle),
+                                                                        maths::fineSin(angle));
+
+                        // An unnormalised plane ray's distance is already perpendicular.
+                        const raycasting::RayHit plane = raycaster.cast(pose.x, pose.y,
+                                                                        camera.dirX + camera.planeX * offsets[i],
+                                                                        camera.dirY + camera.planeY * offsets[i]);
+
+                        if (fine.cellX != plane.cellX || fine.cellY != plane.cellY)
+                        {
+                            otherCells++;
+                            continue;
+                        }
+
+                        const double error = std::abs(static_cast<double>(fine.distance) * cosines[i] - plane.distance);
+                        errorTotal += error;
+                        maxError = std::max(maxError, error);
+                        compared++;
+                    }
+                }
+            }
+
+            const long rays = compared + otherCells;
+
+            errors.rows.push_back({std::to_string(columns), std::to_string(duplicated), format("%.3f", maxSnap),
+                                   rays ? format("%.3f%%", 100.0 * otherCells / rays) : "-",
+                                   compared ? format("%.5f", errorTotal / compared) : "-",
+                                   compared ? format("%.3f", maxError) : "-"});
+        }
+
+        return {timings, errors};
+    }
+
+    std::vector<Table> stepsPerRay(const world::Map& map, const float hfov, const unsigned seed)
+    {
+        constexpr int COLUMNS = 160;
+        constexpr int POSES = 2000;
+
+        Table table{"grid steps per ray, " + std::to_string(COLUMNS) + " columns, " + std::to_string(POSES) + " poses",
+                    {"map", "two-loop probes", "DDA cells", "two-loop misses", "DDA misses"}, {}};
+
+        std::mt19937 random(seed);
+        std::vector<NamedMap> maps;
+        maps.push_back({"stock 13x13", map});
+        maps.push_back({"64x64, 1/50 walls", makeRoom(64, 64, 50, random)});
+        maps.push_back({"256x256, 1/50 walls", makeRoom(256, 256, 50, random)});
+
+        rendering::ColumnTable columnTable;
+        columnTable.rebuild(COLUMNS, 1, hfov);
+        const std::span<const maths::BinaryAngle> angles = columnTable.getAngles();
+
+        for (const NamedMap& named : maps)
+        {
+            const raycasting::Raycaster raycaster{named.map};
+
+            long probes = 0;
+            long cells = 0;
+            long twoLoopMisses = 0;
+            long ddaMisses = 0;
+
+            for (const Pose& pose : makePoses(named.map, POSES, seed))
+            {
+                for (int i = 0; i < COLUMNS; i++)
+                {
+                    const auto angle = static_cast<maths::BinaryAngle>(pose.angle + angles[i]);
+
+                    const TwoLoopCast twoLoops = castTwoLoops(named.map, pose.x, pose.y, maths::binaryAngleToRadians(angle));
+                    probes += twoLoops.probes;
+                    twoLoopMisses += twoLoops.isHit ? 0 : 1;
+
+                    // A DDA walk visits one cell per grid line crossed on the way to the hit.
+                    const raycasting::RayHit hit = raycaster.cast(pose.x, pose.y, maths::fineCos(angle), maths::fineSin(angle));
+
+                    if (hit.side == raycasting::HitSide::None)
+                    {
+                        ddaMisses++;
+                        continue;
+                    }
+
+                    cells += std::abs(hit.cellX - static_cast<int>(pose.x)) + std::abs(hit.cellY - static_cast<int>(pose.y));
+                }
+            }
+
+            const double rays = static_cast<double>(POSES) * COLUMNS;
+
+            table.rows.push_back({named.name, format("%.2f", probes / rays), format("%.2f", cells / rays),
+                                  format("%.2f%%", 100.0 * twoLoopMisses / rays), format("%.2f%%", 100.0 * ddaMisses / rays)});
+        }
+
+        return {table};
+    }
+
+    std::vector<Table> fixedPoint(const world::Map& map, const unsigned seed)
+    {
+        constexpr int COLUMNS = 640;
+        constexpr int TIMED_POSES = 100;
+        constexpr int POSES = 2000;
+
+        Table table{"float cast against castFixed, " + std::to_string(COLUMNS) + " columns, " + std::to_string(POSES) + " poses",
+                    {"map", "float (ns/ray)", "fixed (ns/ray)", "other cell", "mean |err|", "max |err|"}, {}};
+
+        std::mt19937 random(seed);
+        std::vector<NamedMap> maps;
+        maps.push_back({"stock 13x13", map});
+        maps.push_back({"64x64, 1/12 walls", makeRoom(64, 64, 12, random)});
+
+        // Evenly spread column angles across a 90 degree view, as the fixed point build casts them.
+        std::vector<maths::BinaryAngle> angles(COLUMNS);
+
+        for (int i = 0; i < COLUMNS; i++)
+            angles[i] = static_cast<maths::BinaryAngle>((i - COLUMNS / 2) * (maths::BINARY_ANGLES / 4) / COLUMNS);
+
+        for (const NamedMap& named : maps)
+        {
+            const raycasting::Raycaster raycaster{named.map};
+            const std::vector<Pose> poses = makePoses(named.map, POSES, seed);
+            const std::span<const Pose> timedPoses = std::span(poses).first(TIMED_POSES);
+            const double timedRays = static_cast<double>(TIMED_POSES) * COLUMNS;
+
+            const double floatTime = timeMicroseconds([&]
+            {
+                float total = 0.0f;
+
+                for (const Pose& pose : timedPoses)
+                {
+                    for (const maths::BinaryAngle column : angles)
+                    {
+                        const auto angle = static_cast<maths::BinaryAngle>(pose.angle + column);
+                        total += raycaster.cast(pose.x, pose.y, maths::fineCos(angle), maths::fineSin(angle)).distance;
+                    }
+                }
+
+                consume(total);
+            });
+
+            const double fixedTime = timeMicroseconds([&]
+            {
+                maths::Fixed total{};
+
+                for (const Pose& pose : timedPoses)
+                {
+                    const maths::Fixed originX{pose.x};
+                    const maths::Fixed originY{pose.y};
+
+                    for (const maths::BinaryAngle column : angles)
+                        total += raycaster.castFixed(originX, originY, static_cast<maths::BinaryAngle>(pose.angle + column)).distance;
+                }
+
+                consume(static_cast<float>(total));
+            });
+
+            long otherCells = 0;
+            long compared = 0;
+            double errorTotal = 0.0;
+            double maxError = 0.0;
+
+            for (const Pose& pose : poses)
+            {
+                for (const maths::BinaryAngle column : angles)
+                {
+                    const auto angle = static_cast<maths::BinaryAngle>(pose.angle + column);
+                    const raycasting::RayHit hit = raycaster.cast(pose.x, pose.y, maths::fineCos(angle), maths::fineSin(angle));
+                    const raycasting::FixedRayHit fixedHit = raycaster.castFixed(maths::Fixed{pose.x}, maths::Fixed{pose.y}, angle);
+
+                    if (hit.cellX != fixedHit.cellX || hit.cellY != fixedHit.cellY)
+                    {
+                        otherCells++;
+                        continue;
+                    }
+
+                    if (hit.side == raycasting::HitSide::None)
+                        continue;
+
+                    const double error = std::abs(static_cast<double>(static_cast<float>(fixedHit.distance)) - hit.distance);
+                    errorTotal += error;
+                    maxError = std::max(maxError, error);
+                    compared++;
+                }
+            }
+
+            table.rows.push_back({named.name, format("%.1f", floatTime * 1000.0 / timedRays),
+                                  format("%.1f", fixedTime * 1000.0 / timedRays),
+                                  format("%.3f%%", 100.0 * otherCells / (static_cast<double>(POSES) * COLUMNS)),
+                                  compared ? format("%.6f", errorTotal / compared) : "-",
+                                  compared ? format("%.5f", maxError) : "-"});
+        }
+
+        return {table};
+    }
+
+    std::vector<Table> coherentSpans(const world::Map& map, const float hfov, const unsigned seed)
+    {
+        constexpr int TIMED_POSES = 16;
+        constexpr int CHECKED_POSES = 200;
+        constexpr int SPANS[] = {4, 8, 16};
+
+        Table table{"castRays against castRaysCoherent per frame (us)",
+                    {"map", "columns", "castRays", "span 4", "span 8", "span 16", "differing columns"}, {}};
+
+        std::mt19937 random(seed);
+        std::vector<NamedMap> maps;
+        maps.push_back({"stock 13x13", map});
+        maps.push_back({"open 64x64, 1/200 walls", makeRoom(64, 64, 200, random)});
+        maps.push_back({"open 256x256, 1/200 walls", makeRoom(256, 256, 200, random)});
+
+        for (const NamedMap& named : maps)
+        {
+            const raycasting::Raycaster raycaster{named.map};
+            const std::vector<Pose> poses = makePoses(named.map, CHECKED_POSES, seed);
+
+            for (const int columns : {160, 640, 960, 3840})
+            {
+                rendering::ColumnTable columnTable;
+                columnTable.rebuild(columns, 1, hfov);
+                const std::span<const maths::BinaryAngle> angles = columnTable.getAngles();
+
+                // Every pose's directions up front, so only the casting is timed.
+                std::vector<float> dirX(static_cast<std::size_t>(CHECKED_POSES) * columns);
+                std::vector<float> dirY(dirX.size());
+
+                for (int pose = 0; pose < CHECKED_POSES; pose++)
+                {
+                    for (int i = 0; i < columns; i++)
+                    {
+                        const auto angle = static_cast<maths::BinaryAngle>(poses[pose].angle + angles[i]);
+                        dirX[static_cast<std::size_t>(pose) * columns + i] = maths::fineCos(angle);
+                        dirY[static_cast<std::size_t>(pose) * columns + i] = maths::fineSin(angle);
+                    }
+                }
+
+                const auto directions = [&](const std::vector<float>& all, const int pose)
+                {
+                    return std::span<const float>(all).subspan(static_cast<std::size_t>(pose) * columns, columns);
+                };
+
+                std::vector<raycasting::RayHit> hits(columns);
+                std::vector<raycasting::RayHit> spanHits(columns);
+
+                // Span 0 is a full castRays.
+                const auto castFrame = [&](const int pose, const int span, std::span<raycasting::RayHit> out)
+                {
+                    if (span == 0)
+                        raycaster.castRays(poses[pose].x, poses[pose].y, directions(dirX, pose), directions(dirY, pose), out);
+                    else
+                        raycaster.castRaysCoherent(poses[pose].x, poses[pose].y, directions(dirX, pose), directions(dirY, pose),
+                                                   out, span);
+                };
+
+                std::vector<std::string> row{named.name, std::to_string(columns)};
+
+                for (const int span : {0, SPANS[0], SPANS[1], SPANS[2]})
+                {
+                    const double time = timeMicroseconds([&]
+                    {
+                        for (int pose = 0; pose < TIMED_POSES; pose++)
+                            castFrame(pose, span, hits);
+
+                        consume(hits[columns / 2].distance);
+                    });
+
+                    row.push_back(format("%.1f", time / TIMED_POSES));
+                }
+
+                long differing = 0;
+
+                for (int pose = 0; pose < CHECKED_POSES; pose++)
+                {
+                    castFrame(pose, 0, hits);
+
+                    for (const int span : SPANS)
+                    {
+                        castFrame(pose, span, spanHits);
+
+                        for (int i = 0; i < columns; i++)
+                            differing += isSameHit(hits[i], spanHits[i]) ? 0 : 1;
+                    }
+                }
+
+                row.push_back(std::to_string(differing) + " of " + std::to_string(static_cast<long>(CHECKED_POSES) * columns * 3));
+                table.rows.push_back(row);
+            }
+        }
+
+        return {table};
+    }
+
+    std::vector<Table> hitCache(const world::Map& map, const float hfov, const unsigned seed)
+    {
+        constexpr int POSES = 50;
+
+        // The game's turn of 3 radians a second, at 120 frames a second.
+        constexpr float TURN_PER_FRAME = 3.0f * maths::BINARY_ANGLES / (2.0f * std::numbers::pi_v<float>) / 120.0f;
+
+        Table table{"hit cache while turning in place at 120 fps, per turn (us)",
+                    {"columns", "angle step", "frames", "hit rate", "cast every column", "with cache"}, {}};
+
+        const raycasting::Raycaster raycaster{map};
+        const std::vector<Pose> poses = makePoses(map, POSES, seed);
+        raycasting::HitCache cache;
+
+        for (const int columns : {160, 80})
+        {
+            rendering::ColumnTable columnTable;
+            columnTable.rebuild(columns, 1, hfov);
+            const std::span<const maths::BinaryAngle> angles = columnTable.getAngles();
+            const int step = columnTable.getAngleStep();
+
+            std::vector<maths::BinaryAngle> missAngles(columns);
+            std::vector<float> dirX(columns);
+            std::vector<float> dirY(columns);
+            std::vector<raycasting::RayHit> hits(columns);
+
+            for (const int frames : {30, 120})
+            {
+                long cachedColumns = 0;
+
+                // Turns from every pose in steps of the column angle step, as the game does, casting
+                // every column or only the ones the cache misses. Each pose starts with an empty cache.
+                const auto turn = [&](const bool isCaching)
+                {
+                    cachedColumns = 0;
+
+                    for (const Pose& pose : poses)
+                    {
+                        // Neighbouring poses never share an origin, so this empties the cache.
+                        cache.prepare(pose.x, pose.y, map.getRevision());
+
+                        maths::BinaryAngle view = pose.angle;
+                        float remainder = 0.0f;
+
+                        for (int frame = 0; frame < frames; frame++)
+                        {
+                            int misses = 0;
+
+                            for (int i = 0; i < columns; i++)
+                            {
+                                const auto angle = static_cast<maths::BinaryAngle>(view + angles[i]);
+
+                                if (isCaching && cache.find(angle))
+                                {
+                                    cachedColumns++;
+                                    continue;
+                                }
+
+                                missAngles[misses] = angle;
+                                dirX[misses] = maths::fineCos(angle);
+                                dirY[misses] = maths::fineSin(angle);
+                                misses++;
+                            }
+
+                            const std::span<raycasting::RayHit> missHits = std::span(hits).first(misses);
+                            raycaster.castRays(pose.x, pose.y, std::span<const float>(dirX).first(misses),
+                                               std::span<const float>(dirY).first(misses), missHits);
+
+                            if (isCaching)
+                            {
+                                for (int i = 0; i < misses; i++)
+                                    cache.store(missAngles[i], missHits[i]);
+                            }
+
+                            remainder += TURN_PER_FRAME;
+                            const int turned = static_cast<int>(remainder / static_cast<float>(step)) * step;
+                            remainder -= static_cast<float>(turned);
+                            view = static_cast<maths::BinaryAngle>(view + turned);
+                        }
+
+                        consume(hits[0].distance);
+                    }
+                };
+
+                const double uncached = timeMicroseconds([&] { turn(false); });
+                const double cached = timeMicroseconds([&] { turn(true); });
+
+                table.rows.push_back({std::to_string(columns), std::to_string(step), std::to_string(frames),
+                                      format("%.1f%%", 100.0 * cachedColumns / (static_cast<double>(POSES) * frames * columns)),
+                                      format("%.1f", uncached / POSES), format("%.1f", cached / POSES)});
+            }
+        }
+
+        return {table};
+    }
+
+    std::vector<Table> distanceField(const world::Map& map, const unsigned seed)
+    {
+        constexpr int RAYS = 1920;
+
+        Table table{std::to_string(RAYS) + " scalar rays from random poses per frame (us)",
+                    {"map", "walls", "mean wall distance", "walk", "per cell", "cast", "differing hits"}, {}};
+
+        struct Case
+        {
+            int size;
+            int wallOneIn;
+        };
+
+        const Case cases[] = {{64, 50}, {256, 400}, {256, 2000}, {1024, 4000}, {1024, 20000}, {1024, 0}};
+
+        std::mt19937 random(seed);
+        std::vector<NamedMap> maps;
+        maps.push_back({"stock 13x13", map});
+
+        for (const Case& c : cases)
+            maps.push_back({std::to_string(c.size) + "x" + std::to_string(c.size), makeRoom(c.size, c.size, c.wallOneIn, random)});
+
+        const std::string walls[] = {"1/6", "1/50", "1/400", "1/2000", "1/4000", "1/20000", "none"};
+
+        for (std::size_t m = 0; m < maps.size(); m++)
+        {
+            const world::Map& room = maps[m].map;
+            const raycasting::Raycaster raycaster{room};
+            const std::vector<Pose> poses = makePoses(room, RAYS, seed);
+
+            const double perCell = timeMicroseconds([&]
+            {
+                float total = 0.0f;
+
+                for (const Pose& pose : poses)
+                    total += castPerCell(room, pose.x, pose.y, maths::fineCos(pose.angle), maths::fineSin(pose.angle)).distance;
+
+                consume(total);
+            });
+
+            const double cast = timeMicroseconds([&]
+            {
+                float total = 0.0f;
+
+                for (const Pose& pose : poses)
+                    total += raycaster.cast(pose.x, pose.y, maths::fineCos(pose.angle), maths::fineSin(pose.angle)).distance;
+
+                consume(total);
+            });
+
+            int differing = 0;
+
+            for (const Pose& pose : poses)
+            {
+                const float dirX = maths::fineCos(pose.angle);
+                const float dirY = maths::fineSin(pose.angle);
+                differing += isSameHit(castPerCell(room, pose.x, pose.y, dirX, dirY), raycaster.cast(pose.x, pose.y, dirX, dirY)) ? 0 : 1;
+            }
+
+            const bool isJumping = room.getMeanWallDistance() >= raycasting::Raycaster::MIN_MEAN_WALL_DISTANCE_TO_JUMP;
+
+            table.rows.push_back({maps[m].name, walls[m], format("%.1f", room.getMeanWallDistance()),
+                                  isJumping ? "distance field" : "per cell", format("%.1f", perCell), format("%.1f", cast),
+                                  std::to_string(differing)});
+        }
+
+        return {table};
+    }
+
+    std::vector<Table> framebufferLayout(const world::Map& map, const float hfov)
+    {
+        constexpr float FOG_DISTANCE = 64.0f;
+
+        // The destination rows are padded, as a locked texture's may be.
+        constexpr int PITCH_PADDING = 16;
+
+        // The original game's ceiling and floor greys.
+        constexpr std::uint32_t CEILING_COLOUR = 0xFF383838u;
+        constexpr std::uint32_t FLOOR_COLOUR = 0xFF707070u;
+
+        Table table{"ceiling and floor fill, drawWalls and upload per frame (us)",
+                    {"size", "view", "row-major + memcpy", "column-major + transpose", "same image", "indexed + expand"}, {}};
+        Table uploads{"upload alone per frame (us)", {"size", "packed transpose", "indexed scalar", "indexed sse2", "indexed avx2"}, {}};
+
+        const rendering::TextureAtlas atlas = rendering::createDefaultTextures();
+        const rendering::Palette palette = rendering::createDefaultPalette();
+        std::array<std::uint32_t, 256> packedPalette{};
+
+        for (std::size_t i = 0; i < palette.size(); i++)
+            packedPalette[i] = 0xFF000000u | palette[i].r << 16 | palette[i].g << 8 | palette[i].b;
+
+        const rendering::Colormap colormap{palette, packedPalette, 0xFF000000u};
+        const raycasting::Raycaster raycaster{map};
+
+        const std::uint8_t ceilingIndex = rendering::nearestColour(palette, {0x38, 0x38, 0x38});
+        const std::uint8_t floorIndex = rendering::nearestColour(palette, {0x70, 0x70, 0x70});
+
+        struct View
+        {
+            const char* name;
+            Pose pose;
+        };
+
+        const View views[] = {{"centre", {6.5f, 6.5f, maths::BINARY_ANGLES / 8}}, {"near a wall", {1.3f, 5.5f, 0}}};
+
+        struct Size
+        {
+            int width;
+            int height;
+        };
+
+        for (const Size size : {Size{160, 80}, Size{1920, 1080}, Size{3840, 2160}})
+        {
+            const int width = size.width;
+            const int height = size.height;
+            const int pitch = (width + PITCH_PADDING) * static_cast<int>(sizeof(std::uint32_t));
+
+            rendering::ColumnTable columnTable;
+            columnTable.rebuild(width, 1, hfov);
+
+            for (const View& view : views)
+            {
+                std::vector<float> dirX(width);
+                std::vector<float> dirY(width);
+                std::vector<raycasting::RayHit> hits(width);
+
+                for (int i = 0; i < width; i++)
+                {
+                    const auto angle = static_cast<maths::BinaryAngle>(view.pose.angle + columnTable.getAngles()[i]);
+                    dirX[i] = maths::fineCos(angle);
+                    dirY[i] = maths::fineSin(angle);
+                }
+
+                raycaster.castRays(view.pose.x, view.pose.y, dirX, dirY, hits);
+
+                rendering::HitBuffer hitBuffer;
+                hitBuffer.resize(width);
+                hitBuffer.store(0, hits, dirX, dirY, columnTable.getCosines(), view.pose.x, view.pose.y, map);
+
+                // A unit tall wall fills the screen's height at the projection plane's distance.
+                rendering::WallColumns columns;
+                columns.resize(width);
+                columns.project(hitBuffer, {height, width * 0.5f / std::tan(hfov * 0.5f), FOG_DISTANCE}, atlas);
+
+                std::vector<std::uint32_t> rowMajor(static_cast<std::size_t>(width) * height);
+                rendering::Framebuffer framebuffer{width, height};
+                rendering::IndexedFramebuffer indexedFramebuffer{width, height};
+
+                std::vector<std::uint32_t> rowMajorTexture(static_cast<std::size_t>(pitch / 4) * height);
+                std::vector<std::uint32_t> columnMajorTexture(rowMajorTexture.size());
+                std::vector<std::uint32_t> indexedTexture(rowMajorTexture.size());
+
+                const double rowMajorTime = timeMicroseconds([&]
+                {
+                    std::fill(rowMajor.begin(), rowMajor.begin() + static_cast<std::ptrdiff_t>(height / 2) * width, CEILING_COLOUR);
+                    std::fill(rowMajor.begin() + static_cast<std::ptrdiff_t>(height / 2) * width, rowMajor.end(), FLOOR_COLOUR);
+                    drawWallsRowMajor(rowMajor, width, columns, atlas, colormap);
+
+                    for (int y = 0; y < height; y++)
+                        std::memcpy(rowMajorTexture.data() + static_cast<std::size_t>(y) * (pitch / 4),
+                                    rowMajor.data() + static_cast<std::size_t>(y) * width, width * sizeof(std::uint32_t));
+
+                    consume(static_cast<float>(rowMajorTexture[rowMajorTexture.size() / 2]));
+                });
+
+                const double columnMajorTime = timeMicroseconds([&]
+                {
+                    framebuffer.fillRows(0, height / 2, CEILING_COLOUR);
+                    framebuffer.fillRows(height / 2, height, FLOOR_COLOUR);
+                    rendering::drawWalls(framebuffer, columns, atlas, colormap, 1);
+                    framebuffer.copyRowMajor(columnMajorTexture.data(), pitch);
+
+                    consume(static_cast<float>(columnMajorTexture[columnMajorTexture.size() / 2]));
+                });
+
+                // The same frame in palette indices, expanded by the best kernel the CPU has.
+                const double indexedTime = timeMicroseconds([&]
+                {
+                    indexedFramebuffer.fillRows(0, height / 2, ceilingIndex);
+                    indexedFramebuffer.fillRows(height / 2, height, floorIndex);
+                    rendering::drawWalls(indexedFramebuffer, columns, atlas, colormap, 1);
+                    indexedFramebuffer.expandRowMajor(indexedTexture.data(), pitch, packedPalette);
+
+                    consume(static_cast<float>(indexedTexture[indexedTexture.size() / 2]));
+                });
+
+                table.rows.push_back({std::to_string(width) + "x" + std::to_string(height), view.name,
+                                      format("%.1f", rowMajorTime), format("%.1f", columnMajorTime),
+                                      rowMajorTexture == columnMajorTexture ? "yes" : "no", format("%.1f", indexedTime)});
+            }
+
+            // The upload on its own, where the indexed frame has a quarter of the bytes to read.
+            const rendering::Framebuffer framebuffer{width, height};
+            const rendering::IndexedFramebuffer indexedFramebuffer{width, height};
+            std::vector<std::uint32_t> texture(static_cast<std::size_t>(pitch / 4) * height);
+
+            std::vector<std::string> row{std::to_string(width) + "x" + std::to_string(height)};
+
+            row.push_back(format("%.1f", timeMicroseconds([&]
+            {
+                framebuffer.copyRowMajor(texture.data(), pitch);
+                consume(static_cast<float>(texture[texture.size() / 2]));
+            })));
+
+            for (const raycasting::Kernel kernel : {raycasting::Kernel::Scalar, raycasting::Kernel::Sse2, raycasting::Kernel::Avx2})
+            {
+                if (kernel == raycasting::Kernel::Avx2 && !raycasting::simd::isSupported(kernel))
+                {
+                    row.push_back("-");
+                    continue;
+                }
+
+                row.push_back(format("%.1f", timeMicroseconds([&]
+                {
+                    indexedFramebuffer.expandRowMajor(texture.data(), pitch, packedPalette, kernel);
+                    consume(static_cast<float>(texture[texture.size() / 2]));
+                })));
+            }
+
+            uploads.rows.push_back(row);
+        }
+
+        return {table, uploads};
+    }
+
+    std::vector<Table> run(const world::Map& map, const float hfov, const unsigned seed)
+    {
+        std::vector<Table> tables;
+
+        const auto add = [&](std::vector<Table> more)
+        {
+            for (Table& table : more)
+                tables.push_back(std::move(table));
+        };
+
+        add(stepsPerRay(map, hfov, seed));
+        add(rayDirections(map, hfov, seed));
+        add(fixedPoint(map, seed));
+        add(coherentSpans(map, hfov, seed));
+        add(hitCache(map, hfov, seed));
+        add(distanceField(map, seed));
+        add(framebufferLayout(map, hfov));
+        return tables;
+    }
+}
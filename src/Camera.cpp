@@ -0,0 +1,66 @@
+#include "Camera.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace rendering
+{
+    Camera Camera::fromDirection(const float dirX, const float dirY, const float planeScale)
+    {
+        return {dirX, dirY, -dirY * planeScale, dirX * planeScale};
+    }
+
+    Camera Camera::fromAngle(const maths::BinaryAngle angle, const float planeScale)
+    {
+        return fromDirection(maths::fineCos(angle), maths::fineSin(angle), planeScale);
+    }
+
+    void ColumnTable::rebuild(const int screenWidth, const int rayRes, const float hfov)
+    {
+        if (screenWidth == this->screenWidth && rayRes == this->rayRes && hfov == this->hfov)
+            return;
+
+        this->screenWidth = screenWidth;
+        this->rayRes = rayRes;
+        this->hfov = hfov;
+
+        planeScale = std::tan(hfov * 0.5f);
+
+        const int columns = screenWidth / rayRes;
+        const float maxX = static_cast<float>(screenWidth - 1);
+
+        offsets.resize(columns);
+        cosines.resize(columns);
+        angles.resize(columns);
+
+        for (int i = 0; i < columns; i++)
+        {
+            // Map the column's screen X onto [-1, 1] across the camera plane.
+            const float screenX = static_cast<float>(i * rayRes);
+            const float offset = (screenX * 2.0f - maxX) / maxX;
+            const float planeX = offset * planeScale;
+
+            offsets[i] = offset;
+            angles[i] = maths::radiansToBinaryAngle(std::atan(planeX));
+        }
+
+        // Columns are closest together at the edges of the view.
+        int narrowestGap = maths::BINARY_ANGLES;
+
+        for (int i = 1; i < columns; i++)
+            narrowestGap = std::min(narrowestGap, static_cast<int>(static_cast<std::int16_t>(angles[i] - angles[i - 1])));
+
+        angleStep = 1;
+
+        while (angleStep * 8 <= narrowestGap)
+            angleStep *= 2;
+
+        // Rounding wraps with the angle, since the step divides a full turn.
+        for (int i = 0; i < columns; i++)
+        {
+            angles[i] = static_cast<maths::BinaryAngle>((angles[i] + angleStep / 2) & ~(angleStep - 1));
+            cosines[i] = maths::fineCos(angles[i]);
+        }
+    }
+}
@@ -0,0 +1,284 @@
+#include "ChunkedMap.h"
+
+#include "Map.h"
+#include "Maths.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace world
+{
+    namespace
+    {
+        // File layout: the magic, the map's width and height as native int32s, then every chunk in
+        // row-major order as CHUNK_SIZE * CHUNK_SIZE material bytes. Cells past the map's edge are 0.
+        constexpr char MAGIC[8] = {'R', 'C', 'C', 'H', 'U', 'N', 'K', '1'};
+        constexpr std::streamoff HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::int32_t);
+        constexpr int CHUNK_CELLS = ChunkedMap::CHUNK_SIZE * ChunkedMap::CHUNK_SIZE;
+    }
+
+    bool ChunkedMap::write(const std::string& path, const int width, const int height,
+                           const std::function<int(int x, int y)>& cellAt)
+    {
+        std::ofstream out(path, std::ios::binary);
+
+        if (!out || width <= 0 || height <= 0)
+            return false;
+
+        const std::int32_t size[2] = {width, height};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char*>(size), sizeof(size));
+
+        std::array<std::uint8_t, CHUNK_CELLS> materials{};
+
+        for (int chunkY = 0; chunkY < (height + CHUNK_SIZE - 1) >> CHUNK_SHIFT; chunkY++)
+        {
+            for (int chunkX = 0; chunkX < (width + CHUNK_SIZE - 1) >> CHUNK_SHIFT; chunkX++)
+            {
+                for (int localY = 0; localY < CHUNK_SIZE; localY++)
+                {
+                    for (int localX = 0; localX < CHUNK_SIZE; localX++)
+                    {
+                        const int x = (chunkX << CHUNK_SHIFT) + localX;
+                        const int y = (chunkY << CHUNK_SHIFT) + localY;
+
+                        materials[localY * CHUNK_SIZE + localX] =
+                            x < width && y < height ? toMaterial(cellAt(x, y)) : 0;
+                    }
+                }
+
+                out.write(reinterpret_cast<const char*>(materials.data()), CHUNK_CELLS);
+            }
+        }
+
+        return static_cast<bool>(out);
+    }
+
+    std::unique_ptr<ChunkedMap> ChunkedMap::open(const std::string& path, const int residentBudget)
+    {
+        std::ifstream file(path, std::ios::binary);
+
+        char magic[sizeof(MAGIC)];
+        std::int32_t size[2];
+
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+            return nullptr;
+
+        if (!file.read(reinterpret_cast<char*>(size), sizeof(size)) || size[0] <= 0 || size[1] <= 0)
+            return nullptr;
+
+        return std::unique_ptr<ChunkedMap>(new ChunkedMap(std::move(file), size[0], size[1], std::max(residentBudget, 1)));
+    }
+
+    ChunkedMap::ChunkedMap(std::ifstream file, const int width, const int height, const int residentBudget)
+        : width(width), height(height),
+          chunksWide((width + CHUNK_SIZE - 1) >> CHUNK_SHIFT), chunksHigh((height + CHUNK_SIZE - 1) >> CHUNK_SHIFT),
+          residentBudget(residentBudget), directoryWidth(chunksWide + 2), file(std::move(file))
+    {
+        solid.rows.fill(~std::uint64_t{0});
+
+        directory.assign(static_cast<std::size_t>(directoryWidth) * (chunksHigh + 2), &solid);
+        states.assign(static_cast<std::size_t>(chunksWide) * chunksHigh, ChunkState::OnDisk);
+        lastNeeded.assign(states.size(), 0);
+        retryFrames.assign(states.size(), 0);
+        readFailures.assign(states.size(), 0);
+
+        loader = std::thread(&ChunkedMap::loaderLoop, this);
+    }
+
+    ChunkedMap::~ChunkedMap()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+
+        wake.notify_all();
+        loader.join();
+    }
+
+    int ChunkedMap::materialAt(const int x, const int y) const
+    {
+        if (!isInside(x, y))
+            return 0;
+
+        const Chunk& chunk = chunkAt(x, y);
+
+        if (!chunk.isResident)
+            return 0;
+
+        return chunk.materials[(y & (CHUNK_SIZE - 1)) * CHUNK_SIZE + (x & (CHUNK_SIZE - 1))];
+    }
+
+    bool ChunkedMap::updateResidency(const float x, const float y, const float dirX, const float dirY)
+    {
+        frame++;
+
+        // Install whatever the loader finished since the last call.
+        std::vector<std::pair<int, std::unique_ptr<Chunk>>> finished;
+
+        {
+            std::lock_guard lock(mutex);
+            finished.swap(loaded);
+        }
+
+        for (auto& [index, chunk] : finished)
+        {
+            // A chunk that couldn't be read stays solid on disk and is tried again after a while.
+            if (!chunk)
+            {
+                const int shift = std::min<int>(readFailures[index], MAX_RETRY_SHIFT);
+                readFailures[index] = static_cast<std::uint8_t>(std::min(readFailures[index] + 1, 255));
+                retryFrames[index] = frame + (static_cast<std::uint64_t>(READ_RETRY_FRAMES) << shift);
+                states[index] = ChunkState::OnDisk;
+                continue;
+            }
+
+            readFailures[index] = 0;
+            directory[static_cast<std::size_t>(index / chunksWide + 1) * directoryWidth + index % chunksWide + 1] = chunk.get();
+            states[index] = ChunkState::Resident;
+            resident.push_back({std::move(chunk), index});
+            revision++;
+        }
+
+        // The chunks the player needs, nearest first: rings around their chunk, then points ahead.
+        std::vector<int> needed;
+
+        const auto need = [&](const int chunkX, const int chunkY)
+        {
+            if (chunkX < 0 || chunkY < 0 || chunkX >= chunksWide || chunkY >= chunksHigh)
+                return;
+
+            const int index = chunkY * chunksWide + chunkX;
+
+            if (std::find(needed.begin(), needed.end(), index) == needed.end())
+                needed.push_back(index);
+        };
+
+        const int playerChunkX = maths::floorToInt(x) >> CHUNK_SHIFT;
+        const int playerChunkY = maths::floorToInt(y) >> CHUNK_SHIFT;
+
+        for (int ring = 0; ring <= LOAD_RADIUS; ring++)
+        {
+            for (int offsetY = -ring; offsetY <= ring; offsetY++)
+            {
+                for (int offsetX = -ring; offsetX <= ring; offsetX++)
+                {
+                    if (std::max(std::abs(offsetX), std::abs(offsetY)) == ring)
+                        need(playerChunkX + offsetX, playerChunkY + offsetY);
+                }
+            }
+        }
+
+        for (int ahead = LOAD_RADIUS + 1; ahead <= LOAD_RADIUS + PREFETCH_CHUNKS; ahead++)
+        {
+            const float distance = static_cast<float>(ahead * CHUNK_SIZE);
+            need(maths::floorToInt(x + dirX * distance) >> CHUNK_SHIFT, maths::floorToInt(y + dirY * distance) >> CHUNK_SHIFT);
+        }
+
+        if (static_cast<int>(needed.size()) > residentBudget)
+            needed.resize(residentBudget);
+
+        // Replace the load queue, so chunks the player has moved away from are no longer fetched.
+        {
+            std::lock_guard lock(mutex);
+
+            for (const int index : queued)
+                states[index] = ChunkState::OnDisk;
+
+            queued.clear();
+
+            for (const int index : needed)
+            {
+                lastNeeded[index] = frame;
+
+                if (states[index] == ChunkState::OnDisk && frame >= retryFrames[index])
+                {
+                    states[index] = ChunkState::Queued;
+                    queued.push_back(index);
+                }
+            }
+        }
+
+        wake.notify_one();
+
+        // Evict the least recently needed chunks over budget, never ones needed right now.
+        while (static_cast<int>(resident.size()) > residentBudget)
+        {
+            const auto oldest = std::min_element(resident.begin(), resident.end(), [&](const ResidentChunk& a, const ResidentChunk& b)
+            {
+                return lastNeeded[a.index] < lastNeeded[b.index];
+            });
+
+            if (lastNeeded[oldest->index] == frame)
+                break;
+
+            directory[static_cast<std::size_t>(oldest->index / chunksWide + 1) * directoryWidth + oldest->index % chunksWide + 1] = &solid;
+            states[oldest->index] = ChunkState::OnDisk;
+
+            *oldest = std::move(resident.back());
+            resident.pop_back();
+            revision++;
+        }
+
+        return std::any_of(finished.begin(), finished.end(), [](const auto& entry) { return entry.second != nullptr; });
+    }
+
+    void ChunkedMap::loaderLoop()
+    {
+        while (true)
+        {
+            int index;
+
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queued.empty(); });
+
+                if (stopping)
+                    return;
+
+                index = queued.front();
+                queued.pop_front();
+            }
+
+            std::unique_ptr<Chunk> chunk = readChunk(index % chunksWide, index / chunksWide);
+
+            std::lock_guard lock(mutex);
+            loaded.emplace_back(index, std::move(chunk));
+        }
+    }
+
+    std::unique_ptr<ChunkedMap::Chunk> ChunkedMap::readChunk(const int chunkX, const int chunkY)
+    {
+        auto chunk = std::make_unique<Chunk>();
+
+        file.seekg(HEADER_SIZE + static_cast<std::streamoff>(chunkY * chunksWide + chunkX) * CHUNK_CELLS);
+
+        if (!file.read(reinterpret_cast<char*>(chunk->materials.data()), CHUNK_CELLS))
+        {
+            file.clear();
+            return nullptr;
+        }
+
+        for (int localY = 0; localY < CHUNK_SIZE; localY++)
+        {
+            std::uint64_t row = 0;
+
+            for (int localX = 0; localX < CHUNK_SIZE; localX++)
+            {
+                const int x = (chunkX << CHUNK_SHIFT) + localX;
+                const int y = (chunkY << CHUNK_SHIFT) + localY;
+
+                // Cells past the map's edge are walls, so the chunk doubles as part of the border.
+                if (chunk->materials[localY * CHUNK_SIZE + localX] != 0 || x >= width || y >= height)
+                    row |= std::uint64_t{1} << localX;
+            }
+
+            chunk->rows[localY] = row;
+        }
+
+        chunk->isResident = true;
+        return chunk;
+    }
+}
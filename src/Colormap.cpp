@@ -0,0 +1,44 @@
+#include "Colormap.h"
+
+#include <algorithm>
+
+namespace rendering
+{
+    Colormap::Colormap(const Palette& palette, const std::span<const std::uint32_t> packedPalette,
+                       const std::uint32_t alphaMask)
+        : colours(static_cast<std::size_t>(LIGHT_LEVELS) << 8, alphaMask),
+          indices(static_cast<std::size_t>(LIGHT_LEVELS) << 8, 0)
+    {
+        const int count = std::min(static_cast<int>(packedPalette.size()), 256);
+
+        for (int light = 0; light < LIGHT_LEVELS; light++)
+        {
+            // Out of 256, so the brightest level is an exact copy of the palette.
+            const std::uint32_t scale = static_cast<std::uint32_t>(light + 1) << (8 - LIGHT_SHIFT);
+            std::uint32_t* shaded = colours.data() + (light << 8);
+            std::uint8_t* shadedIndices = indices.data() + (light << 8);
+
+            for (int i = 0; i < count; i++)
+            {
+                // Scales all four 8-bit channels at once, two per multiply, then restores the alpha.
+                const std::uint32_t evenChannels = ((packedPalette[i] & 0x00FF00FFu) * scale >> 8) & 0x00FF00FFu;
+                const std::uint32_t oddChannels = ((packedPalette[i] >> 8 & 0x00FF00FFu) * scale) & 0xFF00FF00u;
+
+                shaded[i] = evenChannels | oddChannels | alphaMask;
+            }
+
+            // Indexed framebuffers can only show palette colours, so each shaded colour snaps to the nearest.
+            const auto scaleChannel = [&](const std::uint8_t channel)
+            {
+                return static_cast<std::uint8_t>(channel * scale >> 8);
+            };
+
+            for (int i = 0; i < static_cast<int>(palette.size()); i++)
+            {
+                const Colour& colour = palette[i];
+                shadedIndices[i] = nearestColour(palette, {scaleChannel(colour.r), scaleChannel(colour.g),
+                                                           scaleChannel(colour.b)});
+            }
+        }
+    }
+}
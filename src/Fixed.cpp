@@ -0,0 +1,38 @@
+#include "Fixed.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace maths
+{
+    namespace
+    {
+        // Rounding to 16 fractional bits absorbs any last-bit differences between libm versions.
+        Fixed toFixed(const double value)
+        {
+            constexpr double limit = FixedFineTables::TANGENT_LIMIT;
+            return Fixed::fromRaw(static_cast<std::int32_t>(std::llround(std::clamp(value, -limit, limit) * Fixed::ONE)));
+        }
+    }
+
+    FixedFineTables::FixedFineTables()
+    {
+        for (int i = 0; i < FINE_ANGLES; i++)
+        {
+            const double radians = i * (2.0 * std::numbers::pi / FINE_ANGLES);
+            const bool isVertical = ((i + FINE_ANGLES / 4) % (FINE_ANGLES / 2)) == 0;
+            const bool isHorizontal = (i % (FINE_ANGLES / 2)) == 0;
+
+            const double s = isHorizontal ? 0.0 : std::sin(radians);
+            const double c = isVertical ? 0.0 : std::cos(radians);
+
+            sine[i] = toFixed(s);
+            cosine[i] = toFixed(c);
+            tangent[i] = isVertical ? toFixed(s * TANGENT_LIMIT) : toFixed(s / c);
+            cotangent[i] = isHorizontal ? toFixed(c * TANGENT_LIMIT) : toFixed(c / s);
+        }
+    }
+
+    const FixedFineTables fixedFineTables;
+}
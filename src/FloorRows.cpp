@@ -0,0 +1,194 @@
+#include "FloorRows.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAYCASTER_FLOOR_SSE2 1
+#endif
+
+namespace rendering
+{
+    namespace
+    {
+        constexpr int TEXEL_MASK = TextureAtlas::TEXTURE_SIZE - 1;
+
+        // Draws the floor and ceiling into a framebuffer of any pixel type, with levels giving the shaded
+        // pixels of a light level indexed by texel.
+        template <typename Pixel, typename Levels>
+        void drawFloorPixels(BasicFramebuffer<Pixel>& framebuffer, const FloorRows& rows, const WallColumns& columns,
+                             const TextureAtlas& atlas, const int floorMaterial, const int ceilingMaterial,
+                             const Levels& levels, const int columnWidth)
+        {
+            const int pairs = std::min(rows.size(), framebuffer.getHeight() / 2);
+            const int floorRow = framebuffer.getHeight() - pairs;
+
+            const std::uint8_t* floorTexels = atlas.getTexels().data() + atlas.textureOffset(floorMaterial);
+            const std::uint8_t* ceilingTexels = atlas.getTexels().data() + atlas.textureOffset(ceilingMaterial);
+
+            const float* startX = rows.getStartX().data();
+            const float* startY = rows.getStartY().data();
+            const float* stepX = rows.getStepX().data();
+            const float* stepY = rows.getStepY().data();
+            const std::uint8_t* lightLevels = rows.getLightLevels().data();
+
+#ifdef RAYCASTER_FLOOR_SSE2
+            const __m128i texelMask = _mm_set1_epi32(TEXEL_MASK);
+#endif
+
+            for (int i = 0; i < columns.size(); i++)
+            {
+                // Start at whichever of the wall's ends is nearer the horizon, which the wall then covers, or
+                // at the fog for a wall past it.
+                const int floorStart = columns.getBottoms()[i] - floorRow;
+                const int ceilingStart = pairs - columns.getTops()[i];
+                const int first = std::max({rows.getFirstVisible(), std::min(floorStart, ceilingStart), 0});
+
+                if (first >= pairs)
+                    continue;
+
+                Pixel* column = framebuffer.column(i * columnWidth);
+                const float x = static_cast<float>(i);
+                int pair = first;
+
+#ifdef RAYCASTER_FLOOR_SSE2
+                const __m128 xs = _mm_set1_ps(x);
+
+                for (; pair + 4 <= pairs; pair += 4)
+                {
+                    const __m128 worldX = _mm_add_ps(_mm_loadu_ps(startX + pair), _mm_mul_ps(_mm_loadu_ps(stepX + pair), xs));
+                    const __m128 worldY = _mm_add_ps(_mm_loadu_ps(startY + pair), _mm_mul_ps(_mm_loadu_ps(stepY + pair), xs));
+
+                    // Textures are column-major, so X picks the texture column and Y the texel within it.
+                    const __m128i u = _mm_and_si128(_mm_cvttps_epi32(worldX), texelMask);
+                    const __m128i v = _mm_and_si128(_mm_cvttps_epi32(worldY), texelMask);
+
+                    alignas(16) std::int32_t offsets[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(offsets),
+                                    _mm_or_si128(_mm_slli_epi32(u, TextureAtlas::TEXTURE_SHIFT), v));
+
+                    // SSE2 has no gather, so only the texel and colour fetches are scalar. Each row pair has
+                    // its own light level.
+                    const Pixel* shaded[4] = {levels(lightLevels[pair]), levels(lightLevels[pair + 1]),
+                                              levels(lightLevels[pair + 2]), levels(lightLevels[pair + 3])};
+
+                    const auto fetch = [&](const std::uint8_t* texels, const int lane)
+                    {
+                        return shaded[lane][texels[offsets[lane]]];
+                    };
+
+                    // Ceiling rows run up the screen as pairs run out from the horizon, so they're stored reversed.
+                    if constexpr (sizeof(Pixel) == 4)
+                    {
+                        const auto lanes = [&](const std::uint8_t* texels, const int a, const int b, const int c,
+                                               const int d)
+                        {
+                            return _mm_setr_epi32(static_cast<int>(fetch(texels, a)), static_cast<int>(fetch(texels, b)),
+                                                  static_cast<int>(fetch(texels, c)), static_cast<int>(fetch(texels, d)));
+                        };
+
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(column + floorRow + pair), lanes(floorTexels, 0, 1, 2, 3));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(column + pairs - 4 - pair), lanes(ceilingTexels, 3, 2, 1, 0));
+                    }
+                    else
+                    {
+                        const Pixel floorPixels[4] = {fetch(floorTexels, 0), fetch(floorTexels, 1),
+                                                      fetch(floorTexels, 2), fetch(floorTexels, 3)};
+                        const Pixel ceilingPixels[4] = {fetch(ceilingTexels, 3), fetch(ceilingTexels, 2),
+                                                        fetch(ceilingTexels, 1), fetch(ceilingTexels, 0)};
+
+                        std::memcpy(column + floorRow + pair, floorPixels, sizeof(floorPixels));
+                        std::memcpy(column + pairs - 4 - pair, ceilingPixels, sizeof(ceilingPixels));
+                    }
+                }
+#endif
+
+                // The same for the pairs left over, or every pair without SSE2.
+                for (; pair < pairs; pair++)
+                {
+                    const int u = static_cast<int>(startX[pair] + stepX[pair] * x) & TEXEL_MASK;
+                    const int v = static_cast<int>(startY[pair] + stepY[pair] * x) & TEXEL_MASK;
+                    const int offset = (u << TextureAtlas::TEXTURE_SHIFT) | v;
+                    const Pixel* shaded = levels(lightLevels[pair]);
+
+                    column[floorRow + pair] = shaded[floorTexels[offset]];
+                    column[pairs - 1 - pair] = shaded[ceilingTexels[offset]];
+                }
+
+                // The rest of a wide column is a copy of its first.
+                const std::size_t runBytes = static_cast<std::size_t>(pairs - first) * sizeof(Pixel);
+
+                for (int copy = 1; copy < columnWidth; copy++)
+                {
+                    Pixel* target = framebuffer.column(i * columnWidth + copy);
+                    std::memcpy(target, column, runBytes);
+                    std::memcpy(target + floorRow + first, column + floorRow + first, runBytes);
+                }
+            }
+        }
+    }
+
+    void FloorRows::project(const Camera& camera, const float originX, const float originY,
+                            const std::span<const float> columnOffsets, const WallColumns::Projection& projection)
+    {
+        const int pairs = projection.screenHeight / 2;
+
+        startX.resize(pairs);
+        startY.resize(pairs);
+        stepX.resize(pairs);
+        stepY.resize(pairs);
+        lightLevels.resize(pairs);
+
+        const float centre = static_cast<float>(projection.screenHeight) * 0.5f;
+        const float halfScale = projection.heightScale * 0.5f;
+        const float inverseFog = 1.0f / projection.fogDistance;
+
+        // Offsets step evenly across the camera plane, so only the first and the step are needed.
+        const float firstOffset = columnOffsets.empty() ? 0.0f : columnOffsets.front();
+        const float offsetStep = columnOffsets.size() > 1
+            ? (columnOffsets.back() - columnOffsets.front()) / static_cast<float>(columnOffsets.size() - 1)
+            : 0.0f;
+
+        constexpr float TEXELS = static_cast<float>(TextureAtlas::TEXTURE_SIZE);
+        firstVisible = pairs;
+
+        for (int pair = 0; pair < pairs; pair++)
+        {
+            // The eye is half a wall above the floor, so a row shows the floor at the distance of the wall
+            // whose bottom edge lands on it. Rows are sampled at their centres.
+            const float rowOffset = static_cast<float>(projection.screenHeight - pairs + pair) + 0.5f - centre;
+            const float distance = halfScale / rowOffset;
+
+            // The plane is perpendicular to the view direction, so the ray through a column reaches this
+            // perpendicular distance at distance times its unnormalized direction.
+            startX[pair] = (originX + distance * (camera.dirX + camera.planeX * firstOffset)) * TEXELS;
+            startY[pair] = (originY + distance * (camera.dirY + camera.planeY * firstOffset)) * TEXELS;
+            stepX[pair] = distance * camera.planeX * offsetStep * TEXELS;
+            stepY[pair] = distance * camera.planeY * offsetStep * TEXELS;
+
+            lightLevels[pair] = static_cast<std::uint8_t>(
+                std::max(SHADE * Colormap::LEVELS_PER_BRIGHTNESS * (1.0f - distance * inverseFog), 0.0f));
+
+            // Distances only shrink moving out from the horizon.
+            if (firstVisible == pairs && distance <= projection.fogDistance)
+                firstVisible = pair;
+        }
+    }
+
+    void drawFloors(Framebuffer& framebuffer, const FloorRows& rows, const WallColumns& columns,
+                    const TextureAtlas& atlas, const int floorMaterial, const int ceilingMaterial,
+                    const Colormap& colormap, const int columnWidth)
+    {
+        drawFloorPixels(framebuffer, rows, columns, atlas, floorMaterial, ceilingMaterial,
+                        [&](const int light) { return colormap.level(light); }, columnWidth);
+    }
+
+    void drawFloors(IndexedFramebuffer& framebuffer, const FloorRows& rows, const WallColumns& columns,
+                    const TextureAtlas& atlas, const int floorMaterial, const int ceilingMaterial,
+                    const Colormap& colormap, const int columnWidth)
+    {
+        drawFloorPixels(framebuffer, rows, columns, atlas, floorMaterial, ceilingMaterial,
+                        [&](const int light) { return colormap.indexLevel(light); }, columnWidth);
+    }
+}
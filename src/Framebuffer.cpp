@@ -0,0 +1,292 @@
+#include "Framebuffer.h"
+
+#include <algorithm>
+
+#include "RaycasterSimd.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAYCASTER_TRANSPOSE_SSE2 1
+
+// The gather path is compiled for AVX2 and only taken when the CPU has it.
+#ifdef RAYCASTER_X86
+#include <immintrin.h>
+#define RAYCASTER_EXPAND_AVX2 1
+
+#ifdef _MSC_VER
+#define RAYCASTER_TARGET_AVX2
+#else
+#define RAYCASTER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+namespace rendering
+{
+    namespace
+    {
+        // The transpose works through square tiles this many pixels wide, so a tile's source columns
+        // and destination rows (4 KiB each) stay in L1 while it is turned.
+        constexpr int TILE_SIZE = 32;
+
+        // Transposes the pixels of a tile, or part of one at the frame's edge, one at a time, passing
+        // each through convert.
+        template <typename Pixel, typename Convert>
+        void transposeScalar(const Pixel* source, const int sourceStride, std::uint8_t* destination,
+                             const int pitch, const int firstX, const int lastX, const int firstY, const int lastY,
+                             const Convert& convert)
+        {
+            for (int y = firstY; y < lastY; y++)
+            {
+                auto* row = reinterpret_cast<std::uint32_t*>(destination + static_cast<std::size_t>(y) * pitch);
+
+                for (int x = firstX; x < lastX; x++)
+                    row[x] = convert(source[static_cast<std::size_t>(x) * sourceStride + y]);
+            }
+        }
+
+        template <typename Pixel, typename Convert>
+        void transposeTiles(const Pixel* source, const int width, const int height, std::uint8_t* destination,
+                            const int pitch, const Convert& convert)
+        {
+            for (int tileY = 0; tileY < height; tileY += TILE_SIZE)
+            {
+                for (int tileX = 0; tileX < width; tileX += TILE_SIZE)
+                {
+                    transposeScalar(source, height, destination, pitch, tileX, std::min(tileX + TILE_SIZE, width),
+                                    tileY, std::min(tileY + TILE_SIZE, height), convert);
+                }
+            }
+        }
+
+#ifdef RAYCASTER_TRANSPOSE_SSE2
+        // Turns four columns of four pixels into four rows of four with the unpack network.
+        void transpose4x4(const std::uint32_t* source, const int sourceStride, std::uint32_t* destination,
+                          const int destinationStride)
+        {
+            const __m128i column0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+            const __m128i column1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + sourceStride));
+            const __m128i column2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 2 * sourceStride));
+            const __m128i column3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 3 * sourceStride));
+
+            const __m128i low01 = _mm_unpacklo_epi32(column0, column1);
+            const __m128i low23 = _mm_unpacklo_epi32(column2, column3);
+            const __m128i high01 = _mm_unpackhi_epi32(column0, column1);
+            const __m128i high23 = _mm_unpackhi_epi32(column2, column3);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi64(low01, low23));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + destinationStride), _mm_unpackhi_epi64(low01, low23));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 2 * destinationStride), _mm_unpacklo_epi64(high01, high23));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 3 * destinationStride), _mm_unpackhi_epi64(high01, high23));
+        }
+
+        // Turns sixteen columns of sixteen indices into sixteen rows. Four rounds of interleaving leave
+        // row r in the register whose index is r with its four bits reversed.
+        inline void transpose16x16(const std::uint8_t* source, const int sourceStride, __m128i (&rows)[16])
+        {
+            __m128i lanes[16];
+            __m128i interleaved[16];
+
+            for (int i = 0; i < 16; i++)
+                lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * sourceStride));
+
+            for (int i = 0; i < 8; i++)
+            {
+                interleaved[i] = _mm_unpacklo_epi8(lanes[2 * i], lanes[2 * i + 1]);
+                interleaved[i + 8] = _mm_unpackhi_epi8(lanes[2 * i], lanes[2 * i + 1]);
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                lanes[i] = _mm_unpacklo_epi16(interleaved[2 * i], interleaved[2 * i + 1]);
+                lanes[i + 8] = _mm_unpackhi_epi16(interleaved[2 * i], interleaved[2 * i + 1]);
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                interleaved[i] = _mm_unpacklo_epi32(lanes[2 * i], lanes[2 * i + 1]);
+                interleaved[i + 8] = _mm_unpackhi_epi32(lanes[2 * i], lanes[2 * i + 1]);
+            }
+
+            for (int i = 0; i < 8; i++)
+            {
+                lanes[i] = _mm_unpacklo_epi64(interleaved[2 * i], interleaved[2 * i + 1]);
+                lanes[i + 8] = _mm_unpackhi_epi64(interleaved[2 * i], interleaved[2 * i + 1]);
+            }
+
+            constexpr int BIT_REVERSED[16] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+            for (int y = 0; y < 16; y++)
+                rows[y] = lanes[BIT_REVERSED[y]];
+        }
+
+        // Turns a 16x16 block of indices into rows and expands each through the palette.
+        void expand16x16(const std::uint8_t* source, const int sourceStride, std::uint32_t* destination,
+                         const int destinationStride, const std::uint32_t* palette)
+        {
+            __m128i rows[16];
+            transpose16x16(source, sourceStride, rows);
+
+            for (int y = 0; y < 16; y++)
+            {
+                alignas(16) std::uint8_t indices[16];
+                _mm_store_si128(reinterpret_cast<__m128i*>(indices), rows[y]);
+
+                // SSE2 has no gather, so the palette lookups are scalar and the stores four wide.
+                std::uint32_t* row = destination + static_cast<std::size_t>(y) * destinationStride;
+
+                for (int x = 0; x < 16; x += 4)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x),
+                                     _mm_setr_epi32(static_cast<int>(palette[indices[x]]),
+                                                    static_cast<int>(palette[indices[x + 1]]),
+                                                    static_cast<int>(palette[indices[x + 2]]),
+                                                    static_cast<int>(palette[indices[x + 3]])));
+                }
+            }
+        }
+
+#ifdef RAYCASTER_EXPAND_AVX2
+        // The same block, with the palette lookups gathered eight at a time.
+        RAYCASTER_TARGET_AVX2
+        void expand16x16Avx2(const std::uint8_t* source, const int sourceStride, std::uint32_t* destination,
+                             const int destinationStride, const std::uint32_t* palette)
+        {
+            __m128i rows[16];
+            transpose16x16(source, sourceStride, rows);
+
+            const auto* entries = reinterpret_cast<const int*>(palette);
+
+            for (int y = 0; y < 16; y++)
+            {
+                const __m256i low = _mm256_cvtepu8_epi32(rows[y]);
+                const __m256i high = _mm256_cvtepu8_epi32(_mm_srli_si128(rows[y], 8));
+
+                auto* row = reinterpret_cast<__m256i*>(destination + static_cast<std::size_t>(y) * destinationStride);
+                _mm256_storeu_si256(row, _mm256_i32gather_epi32(entries, low, 4));
+                _mm256_storeu_si256(row + 1, _mm256_i32gather_epi32(entries, high, 4));
+            }
+        }
+#endif
+
+        // Runs block over every blockSize square of the frame, tile by tile, and leaves the right and
+        // bottom edges it can't cover to the scalar transpose.
+        template <int BlockSize, typename Pixel, typename Block, typename Convert>
+        void transposeBlocks(const Pixel* source, const int width, const int height, std::uint8_t* destination,
+                             const int pitch, const Block& block, const Convert& convert)
+        {
+            const int destinationStride = pitch / static_cast<int>(sizeof(std::uint32_t));
+            const int blockWidth = width / BlockSize * BlockSize;
+            const int blockHeight = height / BlockSize * BlockSize;
+
+            for (int tileY = 0; tileY < blockHeight; tileY += TILE_SIZE)
+            {
+                const int lastY = std::min(tileY + TILE_SIZE, blockHeight);
+
+                for (int tileX = 0; tileX < blockWidth; tileX += TILE_SIZE)
+                {
+                    const int lastX = std::min(tileX + TILE_SIZE, blockWidth);
+
+                    for (int x = tileX; x < lastX; x += BlockSize)
+                    {
+                        for (int y = tileY; y < lastY; y += BlockSize)
+                        {
+                            block(source + static_cast<std::size_t>(x) * height + y, height,
+                                  reinterpret_cast<std::uint32_t*>(destination + static_cast<std::size_t>(y) * pitch) + x,
+                                  destinationStride);
+                        }
+                    }
+                }
+            }
+
+            transposeScalar(source, height, destination, pitch, blockWidth, width, 0, height, convert);
+            transposeScalar(source, height, destination, pitch, 0, blockWidth, blockHeight, height, convert);
+        }
+#endif
+    }
+
+    template <typename Pixel>
+    BasicFramebuffer<Pixel>::BasicFramebuffer(const int width, const int height)
+        : width(width), height(height), pixels(static_cast<std::size_t>(width) * height, 0)
+    {
+    }
+
+    template <typename Pixel>
+    void BasicFramebuffer<Pixel>::fillRows(const int firstRow, const int lastRow, const Pixel colour)
+    {
+        for (int x = 0; x < width; x++)
+            std::fill(column(x) + firstRow, column(x) + lastRow, colour);
+    }
+
+    template <typename Pixel>
+    void BasicFramebuffer<Pixel>::fillColumns(const int x, const int columnWidth, const int top, const int bottom,
+                                              const Pixel colour)
+    {
+        for (int i = x; i < x + columnWidth; i++)
+            std::fill(column(i) + top, column(i) + bottom, colour);
+    }
+
+    template <typename Pixel>
+    void BasicFramebuffer<Pixel>::copyRowMajor(void* destination, const int pitch) const requires (sizeof(Pixel) == 4)
+    {
+        auto* rows = static_cast<std::uint8_t*>(destination);
+        const auto copy = [](const std::uint32_t pixel) { return pixel; };
+
+#ifdef RAYCASTER_TRANSPOSE_SSE2
+        // A pitch that isn't a whole number of pixels can't take 32-bit stores, however unlikely.
+        if (pitch % sizeof(std::uint32_t) == 0)
+        {
+            transposeBlocks<4>(pixels.data(), width, height, rows, pitch, transpose4x4, copy);
+            return;
+        }
+#endif
+
+        transposeTiles(pixels.data(), width, height, rows, pitch, copy);
+    }
+
+    template <typename Pixel>
+    void BasicFramebuffer<Pixel>::expandRowMajor(void* destination, const int pitch,
+                                                 const std::span<const std::uint32_t, 256> palette,
+                                                 const raycasting::Kernel kernel) const
+        requires (sizeof(Pixel) == 1)
+    {
+        auto* rows = static_cast<std::uint8_t*>(destination);
+        const auto expand = [&](const std::uint8_t index) { return palette[index]; };
+
+#ifdef RAYCASTER_EXPAND_AVX2
+        if (kernel == raycasting::Kernel::Avx2 && raycasting::simd::isSupported(kernel)
+            && pitch % sizeof(std::uint32_t) == 0)
+        {
+            const auto block = [&](const std::uint8_t* source, const int sourceStride, std::uint32_t* target,
+                                   const int targetStride)
+            {
+                expand16x16Avx2(source, sourceStride, target, targetStride, palette.data());
+            };
+
+            transposeBlocks<16>(pixels.data(), width, height, rows, pitch, block, expand);
+            return;
+        }
+#endif
+
+#ifdef RAYCASTER_TRANSPOSE_SSE2
+        if (kernel != raycasting::Kernel::Scalar && pitch % sizeof(std::uint32_t) == 0)
+        {
+            const auto block = [&](const std::uint8_t* source, const int sourceStride, std::uint32_t* target,
+                                   const int targetStride)
+            {
+                expand16x16(source, sourceStride, target, targetStride, palette.data());
+            };
+
+            transposeBlocks<16>(pixels.data(), width, height, rows, pitch, block, expand);
+            return;
+        }
+#endif
+
+        // Only the SIMD paths choose by kernel.
+        static_cast<void>(kernel);
+        transposeTiles(pixels.data(), width, height, rows, pitch, expand);
+    }
+
+    template class BasicFramebuffer<std::uint32_t>;
+    template class BasicFramebuffer<std::uint8_t>;
+}
@@ -0,0 +1,79 @@
+#include "HitBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rendering
+{
+    namespace
+    {
+        // The largest float below 1.
+        constexpr float LAST_U = 1.0f - std::numeric_limits<float>::epsilon() * 0.5f;
+    }
+
+    void HitBuffer::resize(const int columns)
+    {
+        if (columns == size())
+            return;
+
+        distances.resize(columns);
+        inverseDistances.resize(columns);
+        sides.resize(columns);
+        cells.resize(columns);
+        materials.resize(columns);
+        textureU.resize(columns);
+    }
+
+    void HitBuffer::store(const int first, const std::span<const raycasting::RayHit> hits,
+                          const std::span<const float> dirX, const std::span<const float> dirY,
+                          const std::span<const float> cosines, const float originX, const float originY,
+                          const world::Map& map)
+    {
+        using raycasting::HitSide;
+
+        for (std::size_t i = 0; i < hits.size(); i++)
+        {
+            const raycasting::RayHit& hit = hits[i];
+            const std::size_t column = first + i;
+
+            sides[column] = hit.side;
+
+            if (hit.side == HitSide::None)
+            {
+                distances[column] = std::numeric_limits<float>::max();
+                inverseDistances[column] = 0.0f;
+                cells[column] = -1;
+                materials[column] = 0;
+                textureU[column] = 0.0f;
+                continue;
+            }
+
+            const float distance = hit.distance * cosines[i];
+            distances[column] = distance;
+            inverseDistances[column] = 1.0f / distance;
+            cells[column] = hit.cellY * map.getWidth() + hit.cellX;
+            materials[column] = static_cast<std::uint8_t>(map.materialAt(hit.cellX, hit.cellY));
+
+            // A vertical face runs along Y and a horizontal one along X. Faces seen looking towards -X
+            // or +Y run right to left across the screen, so they are flipped to keep textures unmirrored.
+            float u;
+
+            if (hit.side == HitSide::Vertical)
+            {
+                const float hitY = originY + dirY[i] * hit.distance;
+                u = hitY - std::floor(hitY);
+                u = dirX[i] < 0.0f ? 1.0f - u : u;
+            }
+            else
+            {
+                const float hitX = originX + dirX[i] * hit.distance;
+                u = hitX - std::floor(hitX);
+                u = dirY[i] > 0.0f ? 1.0f - u : u;
+            }
+
+            // Flipping a zero fraction gives exactly 1, which is kept on the face.
+            textureU[column] = std::min(u, LAST_U);
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#include "HitCache.h"
+
+namespace raycasting
+{
+    HitCache::HitCache() : hits(maths::FINE_ANGLES), stamps(maths::FINE_ANGLES, 0)
+    {
+    }
+
+    void HitCache::prepare(const float originX, const float originY, const unsigned mapRevision)
+    {
+        if (originX == this->originX && originY == this->originY && mapRevision == this->mapRevision)
+            return;
+
+        this->originX = originX;
+        this->originY = originY;
+        this->mapRevision = mapRevision;
+
+        generation++;
+    }
+}
@@ -0,0 +1,193 @@
+#include "Map.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace world
+{
+    namespace
+    {
+        // Index of the first set bit from start onwards in the step direction. The sentinel border
+        // guarantees there is one.
+        int findSetBit(const std::uint64_t* words, const int start, const int step)
+        {
+            int wordIndex = start >> 6;
+
+            if (step > 0)
+            {
+                // Clear the bits behind the start, then take the lowest bit left in each word.
+                std::uint64_t word = words[wordIndex] & (~std::uint64_t{0} << (start & 63));
+
+                while (word == 0)
+                    word = words[++wordIndex];
+
+                return (wordIndex << 6) + std::countr_zero(word);
+            }
+
+            std::uint64_t word = words[wordIndex] & (~std::uint64_t{0} >> (63 - (start & 63)));
+
+            while (word == 0)
+                word = words[--wordIndex];
+
+            return (wordIndex << 6) + 63 - std::countl_zero(word);
+        }
+    }
+
+    std::uint8_t toMaterial(const int value)
+    {
+        // Truncating could turn a wall into material 0 while it still counts as a wall.
+        return static_cast<std::uint8_t>(value == 0 ? 0 : std::clamp(value, 1, 255));
+    }
+
+    Map::Map(const int width, const int height, const std::vector<int>& cells)
+        : width(width), height(height),
+          stride(width + 2), rowWords((width + 2 + 63) >> 6), columnWords((height + 2 + 63) >> 6)
+    {
+        rowBits.assign(static_cast<std::size_t>(rowWords) * (height + 2), 0);
+        columnBits.assign(static_cast<std::size_t>(columnWords) * (width + 2), 0);
+        materials.assign(static_cast<std::size_t>(width) * height, 0);
+
+        for (int y = 0; y < height + 2; y++)
+        {
+            for (int x = 0; x < width + 2; x++)
+            {
+                const bool isBorder = x == 0 || y == 0 || x == width + 1 || y == height + 1;
+                const std::size_t index = static_cast<std::size_t>(y - 1) * width + (x - 1);
+                const int value = !isBorder && index < cells.size() ? cells[index] : 0;
+
+                if (!isBorder)
+                {
+                    materials[index] = toMaterial(value);
+                    emptyCells += value == 0 ? 1 : 0;
+                }
+
+                setWallBit(x, y, isBorder || value != 0);
+            }
+        }
+
+        // Three spare bytes let a 32-bit gather load the last cell.
+        wallDistances.assign(static_cast<std::size_t>(stride) * (height + 2) + 3, 0);
+        updateWallDistances(0, 0, width - 1, height - 1);
+    }
+
+    int Map::materialAt(const int x, const int y) const
+    {
+        if (!isInside(x, y))
+            return 0;
+
+        return materials[static_cast<std::size_t>(y) * width + x];
+    }
+
+    void Map::setCell(const int x, const int y, const int value)
+    {
+        if (!isInside(x, y))
+            return;
+
+        std::uint8_t& material = materials[static_cast<std::size_t>(y) * width + x];
+
+        if (material == toMaterial(value))
+            return;
+
+        const bool wasWall = material != 0;
+        material = toMaterial(value);
+        revision++;
+
+        if (wasWall == (material != 0))
+            return;
+
+        setWallBit(x + 1, y + 1, material != 0);
+        emptyCells += material != 0 ? -1 : 1;
+
+        // Only cells within the cap of the changed cell can have it as their nearest wall.
+        updateWallDistances(x - MAX_WALL_DISTANCE, y - MAX_WALL_DISTANCE, x + MAX_WALL_DISTANCE, y + MAX_WALL_DISTANCE);
+    }
+
+    int Map::findWallInRow(const int x, const int y, const int step) const
+    {
+        return findSetBit(rowBits.data() + static_cast<std::size_t>(y + 1) * rowWords, x + 1 + step, step) - 1;
+    }
+
+    int Map::findWallInColumn(const int x, const int y, const int step) const
+    {
+        return findSetBit(columnBits.data() + static_cast<std::size_t>(x + 1) * columnWords, y + 1 + step, step) - 1;
+    }
+
+    void Map::setWallBit(const int paddedX, const int paddedY, const bool isWall)
+    {
+        std::uint64_t& rowWord = rowBits[static_cast<std::size_t>(paddedY) * rowWords + (paddedX >> 6)];
+        std::uint64_t& columnWord = columnBits[static_cast<std::size_t>(paddedX) * columnWords + (paddedY >> 6)];
+        const std::uint64_t rowBit = std::uint64_t{1} << (paddedX & 63);
+        const std::uint64_t columnBit = std::uint64_t{1} << (paddedY & 63);
+
+        rowWord = isWall ? rowWord | rowBit : rowWord & ~rowBit;
+        columnWord = isWall ? columnWord | columnBit : columnWord & ~columnBit;
+    }
+
+    void Map::updateWallDistances(const int minX, const int minY, const int maxX, const int maxY)
+    {
+        // Only cells within the cap of the area can hold its nearest walls, and the shortest king's
+        // move path to them stays inside the widened window, so a two-pass chamfer over it is exact.
+        // The sentinel border is included, so its walls count like any other.
+        const int windowMinX = std::max(minX - MAX_WALL_DISTANCE, -1);
+        const int windowMinY = std::max(minY - MAX_WALL_DISTANCE, -1);
+        const int windowMaxX = std::min(maxX + MAX_WALL_DISTANCE, width);
+        const int windowMaxY = std::min(maxY + MAX_WALL_DISTANCE, height);
+        const int windowWidth = windowMaxX - windowMinX + 1;
+        const int windowHeight = windowMaxY - windowMinY + 1;
+
+        // The window carries a one cell border of open space, so the passes need no bounds checks.
+        const int windowStride = windowWidth + 2;
+        std::vector<std::uint8_t> window(static_cast<std::size_t>(windowStride) * (windowHeight + 2), MAX_WALL_DISTANCE);
+
+        for (int y = 0; y < windowHeight; y++)
+        {
+            for (int x = 0; x < windowWidth; x++)
+            {
+                if (isWall(windowMinX + x, windowMinY + y))
+                    window[(y + 1) * windowStride + x + 1] = 0;
+            }
+        }
+
+        const auto relax = [&](const int index, const int neighbour)
+        {
+            window[index] = std::min<std::uint8_t>(window[index], window[neighbour] + 1);
+        };
+
+        for (int y = 1; y <= windowHeight; y++)
+        {
+            for (int x = 1; x <= windowWidth; x++)
+            {
+                const int index = y * windowStride + x;
+                relax(index, index - windowStride - 1);
+                relax(index, index - windowStride);
+                relax(index, index - windowStride + 1);
+                relax(index, index - 1);
+            }
+        }
+
+        for (int y = windowHeight; y >= 1; y--)
+        {
+            for (int x = windowWidth; x >= 1; x--)
+            {
+                const int index = y * windowStride + x;
+                relax(index, index + windowStride + 1);
+                relax(index, index + windowStride);
+                relax(index, index + windowStride - 1);
+                relax(index, index + 1);
+            }
+        }
+
+        for (int y = std::max(minY, 0); y <= std::min(maxY, height - 1); y++)
+        {
+            for (int x = std::max(minX, 0); x <= std::min(maxX, width - 1); x++)
+            {
+                std::uint8_t& distance = wallDistances[paddedIndex(x, y)];
+                wallDistanceTotal -= distance;
+                distance = window[(y - windowMinY + 1) * windowStride + x - windowMinX + 1];
+                wallDistanceTotal += distance;
+            }
+        }
+
+        meanWallDistance = emptyCells > 0 ? static_cast<float>(wallDistanceTotal) / static_cast<float>(emptyCells) : 0.0f;
+    }
+}
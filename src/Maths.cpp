@@ -2,6 +2,7 @@
 
 #include <numbers>
 #include <cmath>
+#include <algorithm>
 
 namespace maths
 {
@@ -32,4 +33,45 @@ namespace maths
 
         return std::sqrt((x * x) + (y * y));
     }
+    int floorToInt(const float value)
+    {
+        return static_cast<int>(std::floor(value));
+    }
+
+    BinaryAngle radiansToBinaryAngle(const float radians)
+    {
+        const double turns = radians / (2.0 * std::numbers::pi);
+        const auto units = static_cast<std::int64_t>(std::llround(turns * BINARY_ANGLES));
+
+        return static_cast<BinaryAngle>(units & (BINARY_ANGLES - 1));
+    }
+
+    float binaryAngleToRadians(const BinaryAngle angle)
+    {
+        return static_cast<float>(angle * (2.0 * std::numbers::pi / BINARY_ANGLES));
+    }
+
+    FineTables::FineTables()
+    {
+        for (int i = 0; i < FINE_ANGLES; i++)
+        {
+            const double radians = i * (2.0 * std::numbers::pi / FINE_ANGLES);
+            const double s = std::sin(radians);
+            const double c = std::cos(radians);
+
+            // Snap the exact zero crossings so that axis-aligned rays stay axis-aligned.
+            sine[i] = (i % (FINE_ANGLES / 2)) == 0 ? 0.0f : static_cast<float>(s);
+            cosine[i] = ((i + FINE_ANGLES / 4) % (FINE_ANGLES / 2)) == 0 ? 0.0f : static_cast<float>(c);
+
+            tangent[i] = cosine[i] == 0.0f
+                ? (s > 0.0 ? TANGENT_LIMIT : -TANGENT_LIMIT)
+                : static_cast<float>(std::clamp(s / c, -double{TANGENT_LIMIT}, double{TANGENT_LIMIT}));
+
+            cotangent[i] = sine[i] == 0.0f
+                ? (c > 0.0 ? TANGENT_LIMIT : -TANGENT_LIMIT)
+                : static_cast<float>(std::clamp(c / s, -double{TANGENT_LIMIT}, double{TANGENT_LIMIT}));
+        }
+    }
+
+    const FineTables fineTables;
 }
\ No newline at end of file
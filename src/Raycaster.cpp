@@ -0,0 +1,574 @@
+#include "Raycaster.h"
+#include "ChunkedMap.h"
+#include "RaycasterSimd.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace raycasting
+{
+    namespace
+    {
+        // Stand-in for 1 / 0 on axis-aligned rays, large enough that the axis is never stepped.
+        constexpr float PARALLEL_INVERSE = 1e30f;
+
+        RayHit miss()
+        {
+            return {std::numeric_limits<float>::max(), -1, -1, HitSide::None};
+        }
+
+        // Intersects a ray with the face another ray hit, exactly as the DDA walk would compute it.
+        RayHit faceHit(const RayHit& face, const float originX, const float originY, const float dirX, const float dirY)
+        {
+            if (face.side == HitSide::Vertical)
+            {
+                const int faceX = face.cellX + (dirX < 0.0f ? 1 : 0);
+                const float invDirX = dirX != 0.0f ? 1.0f / dirX : PARALLEL_INVERSE;
+
+                return {(static_cast<float>(faceX) - originX) * invDirX, face.cellX, face.cellY, face.side};
+            }
+
+            const int faceY = face.cellY + (dirY < 0.0f ? 1 : 0);
+            const float invDirY = dirY != 0.0f ? 1.0f / dirY : PARALLEL_INVERSE;
+
+            return {(static_cast<float>(faceY) - originY) * invDirY, face.cellX, face.cellY, face.side};
+        }
+
+        // Queries are chunked so each parallel task amortises its dispatch over many rays.
+        constexpr int QUERIES_PER_CHUNK = 256;
+
+        QueryHit resolveQuery(const Raycaster& raycaster, const RayQuery& query)
+        {
+            const RayHit hit = raycaster.cast(query.originX, query.originY, query.dirX, query.dirY, query.maxDistance);
+
+            if (hit.side == HitSide::None)
+                return {false, std::numeric_limits<float>::max(), -1, -1, Face::None, 0.0f, 0.0f};
+
+            Face face;
+
+            if (hit.side == HitSide::Vertical)
+                face = query.dirX < 0.0f ? Face::East : Face::West;
+            else
+                face = query.dirY < 0.0f ? Face::South : Face::North;
+
+            return {true, hit.distance, hit.cellX, hit.cellY, face,
+                    query.originX + query.dirX * hit.distance,
+                    query.originY + query.dirY * hit.distance};
+        }
+
+        // A ray's fixed parameters for a DDA walk across the grid.
+        struct GridWalk
+        {
+            float originX, originY;
+            float dirX, dirY;
+            float invDirX, invDirY;
+            int stepX, stepY;
+            int edgeX, edgeY;
+
+            // Ray distance to the grid line leaving a column or row.
+            float sideX(const int column) const { return (static_cast<float>(column + edgeX) - originX) * invDirX; }
+            float sideY(const int row) const { return (static_cast<float>(row + edgeY) - originY) * invDirY; }
+        };
+
+        struct WalkPosition
+        {
+            int cellX, cellY;
+            float sideDistX, sideDistY;
+        };
+
+        // Skipping a box costs a few cell steps, so shorter reaches are walked.
+        constexpr int MIN_SKIP_REACH = 3;
+
+        // Moves a walk to the last cell it would visit inside an empty box reaching from its cell to
+        // lastX and lastY, with the side distances it would have there, so the next step leaves the
+        // box exactly as a cell by cell walk would have.
+        WalkPosition skipEmptyBox(const GridWalk& walk, const WalkPosition position, const int lastX, const int lastY)
+        {
+            const float exitX = walk.sideX(lastX);
+            const float exitY = walk.sideY(lastY);
+
+            if (exitX < exitY)
+            {
+                // Find the row the walk is in when it crosses the box's x edge, starting from an
+                // estimate and settling it with the walk's own comparisons.
+                int row = std::clamp(maths::floorToInt(walk.originY + walk.dirY * exitX),
+                                     std::min(position.cellY, lastY), std::max(position.cellY, lastY));
+
+                while (row != lastY && walk.sideY(row) <= exitX)
+                    row += walk.stepY;
+
+                while (row != position.cellY && walk.sideY(row - walk.stepY) > exitX)
+                    row -= walk.stepY;
+
+                return {lastX, row, exitX, walk.sideY(row)};
+            }
+
+            int column = std::clamp(maths::floorToInt(walk.originX + walk.dirX * exitY),
+                                    std::min(position.cellX, lastX), std::max(position.cellX, lastX));
+
+            while (column != lastX && walk.sideX(column) < exitY)
+                column += walk.stepX;
+
+            while (column != position.cellX && walk.sideX(column - walk.stepX) >= exitY)
+                column -= walk.stepX;
+
+            return {column, lastY, walk.sideX(column), exitY};
+        }
+
+        FixedRayHit fixedMiss()
+        {
+            return {maths::Fixed::fromRaw(std::numeric_limits<std::int32_t>::max()), -1, -1, HitSide::None};
+        }
+    }
+
+    Raycaster::Raycaster(const world::Map& map) : map(map), kernel(Kernel::Scalar)
+    {
+        setKernel(Kernel::Avx2);
+    }
+
+    void Raycaster::setKernel(const Kernel kernel)
+    {
+#ifdef RAYCASTER_X86
+        if (kernel == Kernel::Avx2 && !simd::isSupported(Kernel::Avx2))
+        {
+            this->kernel = Kernel::Sse2;
+            return;
+        }
+
+        this->kernel = kernel;
+#else
+        this->kernel = Kernel::Scalar;
+#endif
+    }
+
+    void Raycaster::castRays(const float originX, const float originY, const std::span<const float> dirX,
+                             const std::span<const float> dirY, const std::span<RayHit> hits,
+                             const float maxDistance) const
+    {
+        const int count = static_cast<int>(hits.size());
+
+        if (!map.isInside(static_cast<int>(std::floor(originX)), static_cast<int>(std::floor(originY))))
+        {
+            std::fill(hits.begin(), hits.end(), miss());
+            return;
+        }
+
+        switch (kernel)
+        {
+#ifdef RAYCASTER_X86
+        case Kernel::Avx2:
+            simd::castAvx2(map, originX, originY, dirX.data(), dirY.data(), count, hits.data(), maxDistance);
+            break;
+        case Kernel::Sse2:
+            simd::castSse2(map, originX, originY, dirX.data(), dirY.data(), count, hits.data(), maxDistance);
+            break;
+#endif
+        default:
+            for (int i = 0; i < count; i++)
+                hits[i] = cast(originX, originY, dirX[i], dirY[i], maxDistance);
+            break;
+        }
+    }
+
+    void Raycaster::castRaysCoherent(const float originX, const float originY, const std::span<const float> dirX,
+                                     const std::span<const float> dirY, const std::span<RayHit> hits,
+                                     const int maxSpan, const float maxDistance) const
+    {
+        const int count = static_cast<int>(hits.size());
+
+        if (count == 0)
+            return;
+
+        const int span = std::max(1, maxSpan);
+
+        // Cast the span ends as one packet, including the final ray. The scratch buffers are per
+        // thread so that concurrent chunks can share the caster without reallocating each frame.
+        thread_local std::vector<float> endDirX;
+        thread_local std::vector<float> endDirY;
+        thread_local std::vector<RayHit> endHits;
+
+        endDirX.clear();
+        endDirY.clear();
+
+        for (int i = 0; i < count; i += span)
+        {
+            endDirX.push_back(dirX[i]);
+            endDirY.push_back(dirY[i]);
+        }
+
+        if ((count - 1) % span != 0)
+        {
+            endDirX.push_back(dirX[count - 1]);
+            endDirY.push_back(dirY[count - 1]);
+        }
+
+        endHits.resize(endDirX.size());
+        castRays(originX, originY, endDirX, endDirY, endHits, maxDistance);
+
+        for (std::size_t i = 0; i < endHits.size(); i++)
+            hits[std::min(static_cast<int>(i) * span, count - 1)] = endHits[i];
+
+        for (int first = 0; first < count - 1; first += span)
+            fillSpan(originX, originY, dirX, dirY, hits, first, std::min(first + span, count - 1), maxDistance);
+    }
+
+    void Raycaster::fillSpan(const float originX, const float originY, const std::span<const float> dirX,
+                             const std::span<const float> dirY, const std::span<RayHit> hits,
+                             const int first, const int last, const float maxDistance) const
+    {
+        if (last - first < 2)
+            return;
+
+        const RayHit& start = hits[first];
+        const RayHit& end = hits[last];
+
+        if (start.side != HitSide::None && start.side == end.side && start.cellX == end.cellX && start.cellY == end.cellY)
+        {
+            // Matches cast(), which misses a wall it could only reach beyond maxDistance.
+            for (int i = first + 1; i < last; i++)
+            {
+                const RayHit hit = faceHit(start, originX, originY, dirX[i], dirY[i]);
+                hits[i] = hit.distance > maxDistance ? miss() : hit;
+            }
+
+            return;
+        }
+
+        const int middle = (first + last) / 2;
+        hits[middle] = cast(originX, originY, dirX[middle], dirY[middle], maxDistance);
+
+        fillSpan(originX, originY, dirX, dirY, hits, first, middle, maxDistance);
+        fillSpan(originX, originY, dirX, dirY, hits, middle, last, maxDistance);
+    }
+
+    void Raycaster::castQueries(const std::span<const RayQuery> queries, const std::span<QueryHit> results) const
+    {
+        assert(results.size() == queries.size());
+
+        for (std::size_t i = 0; i < queries.size(); i++)
+            results[i] = resolveQuery(*this, queries[i]);
+    }
+
+    void Raycaster::castQueries(const std::span<const RayQuery> queries, const std::span<QueryHit> results,
+                                util::ThreadPool& pool) const
+    {
+        assert(results.size() == queries.size());
+
+        const int count = static_cast<int>(queries.size());
+        const int chunkCount = (count + QUERIES_PER_CHUNK - 1) / QUERIES_PER_CHUNK;
+
+        pool.run(chunkCount, [&](const int chunk)
+        {
+            const int first = chunk * QUERIES_PER_CHUNK;
+            const int size = std::min(QUERIES_PER_CHUNK, count - first);
+
+            castQueries(queries.subspan(first, size), results.subspan(first, size));
+        });
+    }
+
+    RayHit Raycaster::cast(const float originX, const float originY, const float dirX, const float dirY,
+                           const float maxDistance) const
+    {
+        int cellX = static_cast<int>(std::floor(originX));
+        int cellY = static_cast<int>(std::floor(originY));
+
+        if (!map.isInside(cellX, cellY))
+            return miss();
+
+        const int stepX = dirX < 0.0f ? -1 : 1;
+        const int stepY = dirY < 0.0f ? -1 : 1;
+
+        const float invDirX = dirX != 0.0f ? 1.0f / dirX : PARALLEL_INVERSE;
+        const float invDirY = dirY != 0.0f ? 1.0f / dirY : PARALLEL_INVERSE;
+
+        // The grid line a ray leaving a cell crosses is the cell's far edge when stepping positively.
+        const int edgeX = stepX > 0 ? 1 : 0;
+        const int edgeY = stepY > 0 ? 1 : 0;
+
+        const GridWalk walk{originX, originY, dirX, dirY, invDirX, invDirY, stepX, stepY, edgeX, edgeY};
+
+        // An axis-aligned ray never leaves its row or column, so the occupancy bits find its wall a word
+        // at a time. The distance is the one the walk would reach it with, so results match exactly.
+        if (dirY == 0.0f && dirX != 0.0f)
+        {
+            const int wallX = map.findWallInRow(cellX, cellY, stepX);
+            const float distance = walk.sideX(wallX - stepX);
+
+            if (distance > maxDistance || !map.isInside(wallX, cellY))
+                return miss();
+
+            return {distance, wallX, cellY, HitSide::Vertical};
+        }
+
+        if (dirX == 0.0f && dirY != 0.0f)
+        {
+            const int wallY = map.findWallInColumn(cellX, cellY, stepY);
+            const float distance = walk.sideY(wallY - stepY);
+
+            if (distance > maxDistance || !map.isInside(cellX, wallY))
+                return miss();
+
+            return {distance, cellX, wallY, HitSide::Horizontal};
+        }
+
+        // Ray distance to the next vertical and horizontal grid line. These are recomputed from the
+        // origin rather than accumulated, so the hit distance does not depend on the route taken.
+        float sideDistX = walk.sideX(cellX);
+        float sideDistY = walk.sideY(cellY);
+
+        if (map.getMeanWallDistance() < MIN_MEAN_WALL_DISTANCE_TO_JUMP)
+        {
+            while (true)
+            {
+                if (std::min(sideDistX, sideDistY) > maxDistance)
+                    return miss();
+
+                if (sideDistX < sideDistY)
+                {
+                    cellX += stepX;
+
+                    if (map.isWall(cellX, cellY))
+                        return map.isInside(cellX, cellY) ? RayHit{sideDistX, cellX, cellY, HitSide::Vertical} : miss();
+
+                    sideDistX = walk.sideX(cellX);
+                }
+                else
+                {
+                    cellY += stepY;
+
+                    if (map.isWall(cellX, cellY))
+                        return map.isInside(cellX, cellY) ? RayHit{sideDistY, cellX, cellY, HitSide::Horizontal} : miss();
+
+                    sideDistY = walk.sideY(cellY);
+                }
+            }
+        }
+
+        // Jumps across the empty square the distance field guarantees around the walk's cell. The walk
+        // state stays in locals; copying it through the skip keeps it in registers.
+        const auto skipEmptySpace = [&](const int wallDistance)
+        {
+            const int reach = wallDistance - 1;
+
+            if (reach < MIN_SKIP_REACH)
+                return;
+
+            const WalkPosition position = skipEmptyBox(walk, {cellX, cellY, sideDistX, sideDistY},
+                                                       cellX + reach * stepX, cellY + reach * stepY);
+
+            cellX = position.cellX;
+            cellY = position.cellY;
+            sideDistX = position.sideDistX;
+            sideDistY = position.sideDistY;
+        };
+
+        skipEmptySpace(map.wallDistance(cellX, cellY));
+
+        while (true)
+        {
+            if (std::min(sideDistX, sideDistY) > maxDistance)
+                return miss();
+
+            if (sideDistX < sideDistY)
+            {
+                cellX += stepX;
+
+                // The distance field doubles as the occupancy test, so a step costs one byte load. Its
+                // sentinel border stops the walk at the edge of the map.
+                const int wallDistance = map.wallDistance(cellX, cellY);
+
+                if (wallDistance == 0)
+                    return map.isInside(cellX, cellY) ? RayHit{sideDistX, cellX, cellY, HitSide::Vertical} : miss();
+
+                sideDistX = walk.sideX(cellX);
+                skipEmptySpace(wallDistance);
+            }
+            else
+            {
+                cellY += stepY;
+
+                const int wallDistance = map.wallDistance(cellX, cellY);
+
+                if (wallDistance == 0)
+                    return map.isInside(cellX, cellY) ? RayHit{sideDistY, cellX, cellY, HitSide::Horizontal} : miss();
+
+                sideDistY = walk.sideY(cellY);
+                skipEmptySpace(wallDistance);
+            }
+        }
+    }
+
+    FixedRayHit Raycaster::castFixed(const maths::Fixed originX, const maths::Fixed originY,
+                                     const maths::BinaryAngle angle, const maths::Fixed maxDistance) const
+    {
+        using maths::Fixed;
+
+        int cellX = originX.floorToInt();
+        int cellY = originY.floorToInt();
+
+        if (!map.isInside(cellX, cellY))
+            return fixedMiss();
+
+        // A cell more than this many cells from the origin's along either axis is over maxDistance away.
+        const int originCellX = cellX;
+        const int originCellY = cellY;
+        const int maxCells = maxDistance.floorToInt() + 1;
+
+        const Fixed cos = maths::fixedCos(angle);
+        const Fixed sin = maths::fixedSin(angle);
+        const Fixed tan = maths::fixedTan(angle);
+        const Fixed cot = maths::fixedCot(angle);
+
+        const int stepX = cos < Fixed{} ? -1 : 1;
+        const int stepY = sin < Fixed{} ? -1 : 1;
+
+        // The next vertical and horizontal grid lines, and where the ray crosses each of them.
+        Fixed xBoundary{cellX + (stepX > 0 ? 1 : 0)};
+        Fixed yBoundary{cellY + (stepY > 0 ? 1 : 0)};
+        Fixed yIntercept = originY + (xBoundary - originX) * tan;
+        Fixed xIntercept = originX + (yBoundary - originY) * cot;
+
+        const Fixed yStep = stepX > 0 ? tan : -tan;
+        const Fixed xStep = stepY > 0 ? cot : -cot;
+
+        const auto distanceTo = [&](const Fixed hitX, const Fixed hitY)
+        {
+            return (hitX - originX) * cos + (hitY - originY) * sin;
+        };
+
+        while (true)
+        {
+            // The vertical line comes first if the ray crosses it before leaving the current row.
+            const bool isVerticalFirst = stepY > 0 ? yIntercept < yBoundary : yIntercept > yBoundary;
+
+            if (isVerticalFirst)
+            {
+                cellX += stepX;
+
+                if (std::abs(cellX - originCellX) > maxCells)
+                    return fixedMiss();
+
+                if (map.isWall(cellX, cellY))
+                {
+                    const Fixed distance = distanceTo(xBoundary, yIntercept);
+
+                    if (!map.isInside(cellX, cellY) || distance > maxDistance)
+                        return fixedMiss();
+
+                    return {distance, cellX, cellY, HitSide::Vertical};
+                }
+
+                xBoundary += Fixed{stepX};
+                yIntercept += yStep;
+            }
+            else
+            {
+                cellY += stepY;
+
+                if (std::abs(cellY - originCellY) > maxCells)
+                    return fixedMiss();
+
+                if (map.isWall(cellX, cellY))
+                {
+                    const Fixed distance = distanceTo(xIntercept, yBoundary);
+
+                    if (!map.isInside(cellX, cellY) || distance > maxDistance)
+                        return fixedMiss();
+
+                    return {distance, cellX, cellY, HitSide::Horizontal};
+                }
+
+                yBoundary += Fixed{stepY};
+                xIntercept += xStep;
+            }
+        }
+    }
+
+    ChunkedRaycaster::ChunkedRaycaster(const world::ChunkedMap& map) : map(map)
+    {
+    }
+
+    RayHit ChunkedRaycaster::cast(const float originX, const float originY, const float dirX, const float dirY,
+                                  const float maxDistance) const
+    {
+        using world::ChunkedMap;
+
+        int cellX = static_cast<int>(std::floor(originX));
+        int cellY = static_cast<int>(std::floor(originY));
+
+        if (!map.isInside(cellX, cellY))
+            return miss();
+
+        const int stepX = dirX < 0.0f ? -1 : 1;
+        const int stepY = dirY < 0.0f ? -1 : 1;
+
+        const float invDirX = dirX != 0.0f ? 1.0f / dirX : PARALLEL_INVERSE;
+        const float invDirY = dirY != 0.0f ? 1.0f / dirY : PARALLEL_INVERSE;
+
+        const int edgeX = stepX > 0 ? 1 : 0;
+        const int edgeY = stepY > 0 ? 1 : 0;
+
+        const GridWalk walk{originX, originY, dirX, dirY, invDirX, invDirY, stepX, stepY, edgeX, edgeY};
+
+        float sideDistX = walk.sideX(cellX);
+        float sideDistY = walk.sideY(cellY);
+
+        // The local coordinate a step lands on when it has just crossed into the next chunk.
+        constexpr int localMask = ChunkedMap::CHUNK_SIZE - 1;
+        const int chunkEntryX = stepX > 0 ? 0 : localMask;
+        const int chunkEntryY = stepY > 0 ? 0 : localMask;
+
+        const ChunkedMap::Chunk* chunk = &map.chunkAt(cellX, cellY);
+
+        // Unloaded chunks and the border are solid, so only a stopped walk needs to know which it hit.
+        const auto stop = [&](const float distance, const HitSide side)
+        {
+            if (!chunk->isResident || !map.isInside(cellX, cellY))
+                return miss();
+
+            return RayHit{distance, cellX, cellY, side};
+        };
+
+        while (true)
+        {
+            if (std::min(sideDistX, sideDistY) > maxDistance)
+                return miss();
+
+            if (sideDistX < sideDistY)
+            {
+                cellX += stepX;
+
+                if ((cellX & localMask) == chunkEntryX)
+                    chunk = &map.chunkAt(cellX, cellY);
+
+                if (chunk->isWall(cellX & localMask, cellY & localMask))
+                    return stop(sideDistX, HitSide::Vertical);
+
+                sideDistX = walk.sideX(cellX);
+            }
+            else
+            {
+                cellY += stepY;
+
+                if ((cellY & localMask) == chunkEntryY)
+                    chunk = &map.chunkAt(cellX, cellY);
+
+                if (chunk->isWall(cellX & localMask, cellY & localMask))
+                    return stop(sideDistY, HitSide::Horizontal);
+
+                sideDistY = walk.sideY(cellY);
+            }
+        }
+    }
+
+    void ChunkedRaycaster::castRays(const float originX, const float originY, const std::span<const float> dirX,
+                                    const std::span<const float> dirY, const std::span<RayHit> hits) const
+    {
+        for (std::size_t i = 0; i < hits.size(); i++)
+            hits[i] = cast(originX, originY, dirX[i], dirY[i]);
+    }
+}
@@ -0,0 +1,333 @@
+#include "RaycasterSimd.h"
+
+#ifdef RAYCASTER_X86
+
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RAYCASTER_TARGET_SSE2
+#define RAYCASTER_TARGET_AVX2
+#else
+#define RAYCASTER_TARGET_SSE2 __attribute__((target("sse2")))
+#define RAYCASTER_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace raycasting::simd
+{
+    namespace
+    {
+        // Must match the scalar caster's stand-in for 1 / 0.
+        constexpr float PARALLEL_INVERSE = 1e30f;
+
+        bool cpuHasAvx2()
+        {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+
+            if (info[0] < 7)
+                return false;
+
+            // The OS has to save the YMM registers as well as the CPU supporting the instructions.
+            __cpuid(info, 1);
+            const bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+
+            if (!hasOsxsave || (_xgetbv(0) & 0x6) != 0x6)
+                return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        void storeHits(const float* distance, const int* cellX, const int* cellY, const int* side,
+                       const int count, RayHit* hits)
+        {
+            for (int i = 0; i < count; i++)
+                hits[i] = {distance[i], cellX[i], cellY[i], static_cast<HitSide>(side[i])};
+        }
+
+        RAYCASTER_TARGET_SSE2 __m128 selectPs(const __m128 mask, const __m128 a, const __m128 b)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        RAYCASTER_TARGET_SSE2 __m128i selectEpi32(const __m128i mask, const __m128i a, const __m128i b)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        }
+
+        RAYCASTER_TARGET_SSE2 void castGroupSse2(const world::Map& map, const float originX, const float originY,
+                                                 const float* dirXIn, const float* dirYIn, const int count,
+                                                 RayHit* hits, const float maxDistanceIn)
+        {
+            constexpr int LANES = 4;
+
+            alignas(16) float dirXLanes[LANES]{};
+            alignas(16) float dirYLanes[LANES]{};
+            alignas(16) int laneEnabled[LANES]{};
+
+            for (int i = 0; i < count; i++)
+            {
+                dirXLanes[i] = dirXIn[i];
+                dirYLanes[i] = dirYIn[i];
+                laneEnabled[i] = -1;
+            }
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i allOnes = _mm_set1_epi32(-1);
+
+            const __m128 dirX = _mm_load_ps(dirXLanes);
+            const __m128 dirY = _mm_load_ps(dirYLanes);
+            const __m128 rayOriginX = _mm_set1_ps(originX);
+            const __m128 rayOriginY = _mm_set1_ps(originY);
+
+            __m128i cellX = _mm_set1_epi32(static_cast<int>(std::floor(originX)));
+            __m128i cellY = _mm_set1_epi32(static_cast<int>(std::floor(originY)));
+
+            // A negative direction steps by -1 (all bits set) and crosses the cell's near edge.
+            const __m128i negativeX = _mm_castps_si128(_mm_cmplt_ps(dirX, zero));
+            const __m128i negativeY = _mm_castps_si128(_mm_cmplt_ps(dirY, zero));
+            const __m128i stepX = _mm_or_si128(negativeX, one);
+            const __m128i stepY = _mm_or_si128(negativeY, one);
+            const __m128i edgeX = _mm_andnot_si128(negativeX, one);
+            const __m128i edgeY = _mm_andnot_si128(negativeY, one);
+
+            const __m128 parallel = _mm_set1_ps(PARALLEL_INVERSE);
+            const __m128 invDirX = selectPs(_mm_cmpeq_ps(dirX, zero), parallel, _mm_div_ps(_mm_set1_ps(1.0f), dirX));
+            const __m128 invDirY = selectPs(_mm_cmpeq_ps(dirY, zero), parallel, _mm_div_ps(_mm_set1_ps(1.0f), dirY));
+
+            __m128 sideDistX = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(cellX, edgeX)), rayOriginX), invDirX);
+            __m128 sideDistY = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(cellY, edgeY)), rayOriginY), invDirY);
+
+            const __m128i width = _mm_set1_epi32(map.getWidth());
+            const __m128i height = _mm_set1_epi32(map.getHeight());
+            const __m128i vertical = _mm_set1_epi32(static_cast<int>(HitSide::Vertical));
+            const __m128i horizontal = _mm_set1_epi32(static_cast<int>(HitSide::Horizontal));
+            const std::uint8_t* distances = map.wallDistanceData();
+            const int stride = map.getStride();
+            const __m128 maxDistance = _mm_set1_ps(maxDistanceIn);
+
+            __m128i active = _mm_load_si128(reinterpret_cast<const __m128i*>(laneEnabled));
+            __m128 hitDistance = _mm_set1_ps(std::numeric_limits<float>::max());
+            __m128i hitCellX = allOnes;
+            __m128i hitCellY = allOnes;
+            __m128i hitSide = _mm_setzero_si128();
+
+            while (true)
+            {
+                // Like cast(), a lane whose next crossing is beyond maxDistance retires as a miss.
+                const __m128 beyond = _mm_cmpgt_ps(_mm_min_ps(sideDistX, sideDistY), maxDistance);
+                active = _mm_andnot_si128(_mm_castps_si128(beyond), active);
+
+                if (_mm_movemask_epi8(active) == 0)
+                    break;
+
+                const __m128 stepsX = _mm_cmplt_ps(sideDistX, sideDistY);
+                const __m128i stepsXi = _mm_castps_si128(stepsX);
+
+                cellX = _mm_add_epi32(cellX, _mm_and_si128(stepsXi, stepX));
+                cellY = _mm_add_epi32(cellY, _mm_andnot_si128(stepsXi, stepY));
+
+                // SSE2 has no gather, so emulate one with per-lane loads. Active lanes never pass the
+                // sentinel border, and retired lanes read cell 0 and have their result cleared afterwards.
+                alignas(16) int laneX[LANES];
+                alignas(16) int laneY[LANES];
+                alignas(16) int laneCell[LANES];
+                _mm_store_si128(reinterpret_cast<__m128i*>(laneX), _mm_and_si128(cellX, active));
+                _mm_store_si128(reinterpret_cast<__m128i*>(laneY), _mm_and_si128(cellY, active));
+
+                for (int i = 0; i < LANES; i++)
+                    laneCell[i] = distances[laneY[i] * stride + laneX[i]];
+
+                const __m128i cell = _mm_load_si128(reinterpret_cast<const __m128i*>(laneCell));
+                const __m128i wall = _mm_and_si128(_mm_cmpeq_epi32(cell, _mm_setzero_si128()), active);
+
+                // Only walls inside the map are hits; the border means the ray left it.
+                const __m128i inside = _mm_and_si128(
+                    _mm_and_si128(_mm_cmpgt_epi32(cellX, allOnes), _mm_cmpgt_epi32(width, cellX)),
+                    _mm_and_si128(_mm_cmpgt_epi32(cellY, allOnes), _mm_cmpgt_epi32(height, cellY)));
+                const __m128i hit = _mm_and_si128(wall, inside);
+
+                hitDistance = selectPs(_mm_castsi128_ps(hit), selectPs(stepsX, sideDistX, sideDistY), hitDistance);
+                hitCellX = selectEpi32(hit, cellX, hitCellX);
+                hitCellY = selectEpi32(hit, cellY, hitCellY);
+                hitSide = selectEpi32(hit, selectEpi32(stepsXi, vertical, horizontal), hitSide);
+
+                active = _mm_andnot_si128(wall, active);
+
+                const __m128 nextX = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(cellX, edgeX)), rayOriginX), invDirX);
+                const __m128 nextY = _mm_mul_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_add_epi32(cellY, edgeY)), rayOriginY), invDirY);
+                sideDistX = selectPs(stepsX, nextX, sideDistX);
+                sideDistY = selectPs(stepsX, sideDistY, nextY);
+            }
+
+            alignas(16) float distance[LANES];
+            alignas(16) int resultX[LANES];
+            alignas(16) int resultY[LANES];
+            alignas(16) int side[LANES];
+            _mm_store_ps(distance, hitDistance);
+            _mm_store_si128(reinterpret_cast<__m128i*>(resultX), hitCellX);
+            _mm_store_si128(reinterpret_cast<__m128i*>(resultY), hitCellY);
+            _mm_store_si128(reinterpret_cast<__m128i*>(side), hitSide);
+
+            storeHits(distance, resultX, resultY, side, count, hits);
+        }
+
+        RAYCASTER_TARGET_AVX2 void castGroupAvx2(const world::Map& map, const float originX, const float originY,
+                                                 const float* dirXIn, const float* dirYIn, const int count,
+                                                 RayHit* hits, const float maxDistanceIn)
+        {
+            constexpr int LANES = 8;
+
+            alignas(32) float dirXLanes[LANES]{};
+            alignas(32) float dirYLanes[LANES]{};
+            alignas(32) int laneEnabled[LANES]{};
+
+            for (int i = 0; i < count; i++)
+            {
+                dirXLanes[i] = dirXIn[i];
+                dirYLanes[i] = dirYIn[i];
+                laneEnabled[i] = -1;
+            }
+
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256i one = _mm256_set1_epi32(1);
+            const __m256i allOnes = _mm256_set1_epi32(-1);
+
+            const __m256 dirX = _mm256_load_ps(dirXLanes);
+            const __m256 dirY = _mm256_load_ps(dirYLanes);
+            const __m256 rayOriginX = _mm256_set1_ps(originX);
+            const __m256 rayOriginY = _mm256_set1_ps(originY);
+
+            __m256i cellX = _mm256_set1_epi32(static_cast<int>(std::floor(originX)));
+            __m256i cellY = _mm256_set1_epi32(static_cast<int>(std::floor(originY)));
+
+            const __m256i negativeX = _mm256_castps_si256(_mm256_cmp_ps(dirX, zero, _CMP_LT_OQ));
+            const __m256i negativeY = _mm256_castps_si256(_mm256_cmp_ps(dirY, zero, _CMP_LT_OQ));
+            const __m256i stepX = _mm256_or_si256(negativeX, one);
+            const __m256i stepY = _mm256_or_si256(negativeY, one);
+            const __m256i edgeX = _mm256_andnot_si256(negativeX, one);
+            const __m256i edgeY = _mm256_andnot_si256(negativeY, one);
+
+            const __m256 parallel = _mm256_set1_ps(PARALLEL_INVERSE);
+            const __m256 invDirX = _mm256_blendv_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), dirX), parallel,
+                                                    _mm256_cmp_ps(dirX, zero, _CMP_EQ_OQ));
+            const __m256 invDirY = _mm256_blendv_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), dirY), parallel,
+                                                    _mm256_cmp_ps(dirY, zero, _CMP_EQ_OQ));
+
+            __m256 sideDistX = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(cellX, edgeX)), rayOriginX), invDirX);
+            __m256 sideDistY = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(cellY, edgeY)), rayOriginY), invDirY);
+
+            const __m256i width = _mm256_set1_epi32(map.getWidth());
+            const __m256i height = _mm256_set1_epi32(map.getHeight());
+            const __m256i vertical = _mm256_set1_epi32(static_cast<int>(HitSide::Vertical));
+            const __m256i horizontal = _mm256_set1_epi32(static_cast<int>(HitSide::Horizontal));
+            const std::uint8_t* distances = map.wallDistanceData();
+            const __m256i stride = _mm256_set1_epi32(map.getStride());
+            const __m256i lowByte = _mm256_set1_epi32(0xFF);
+            const __m256 maxDistance = _mm256_set1_ps(maxDistanceIn);
+
+            __m256i active = _mm256_load_si256(reinterpret_cast<const __m256i*>(laneEnabled));
+            __m256 hitDistance = _mm256_set1_ps(std::numeric_limits<float>::max());
+            __m256i hitCellX = allOnes;
+            __m256i hitCellY = allOnes;
+            __m256i hitSide = _mm256_setzero_si256();
+
+            while (true)
+            {
+                const __m256 beyond = _mm256_cmp_ps(_mm256_min_ps(sideDistX, sideDistY), maxDistance, _CMP_GT_OQ);
+                active = _mm256_andnot_si256(_mm256_castps_si256(beyond), active);
+
+                if (_mm256_testz_si256(active, active))
+                    break;
+
+                const __m256 stepsX = _mm256_cmp_ps(sideDistX, sideDistY, _CMP_LT_OQ);
+                const __m256i stepsXi = _mm256_castps_si256(stepsX);
+
+                cellX = _mm256_add_epi32(cellX, _mm256_and_si256(stepsXi, stepX));
+                cellY = _mm256_add_epi32(cellY, _mm256_andnot_si256(stepsXi, stepY));
+
+                // Active lanes never pass the sentinel border, so only retired lanes need masking. Each
+                // lane gathers the 32 bits starting at its cell's byte and keeps the low one.
+                const __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(cellY, stride), cellX);
+                const __m256i cell = _mm256_and_si256(
+                    _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(distances),
+                                                index, active, 1),
+                    lowByte);
+
+                const __m256i wall = _mm256_and_si256(_mm256_cmpeq_epi32(cell, _mm256_setzero_si256()), active);
+
+                // Only walls inside the map are hits; the border means the ray left it.
+                const __m256i inside = _mm256_and_si256(
+                    _mm256_and_si256(_mm256_cmpgt_epi32(cellX, allOnes), _mm256_cmpgt_epi32(width, cellX)),
+                    _mm256_and_si256(_mm256_cmpgt_epi32(cellY, allOnes), _mm256_cmpgt_epi32(height, cellY)));
+                const __m256i hit = _mm256_and_si256(wall, inside);
+
+                hitDistance = _mm256_blendv_ps(hitDistance, _mm256_blendv_ps(sideDistY, sideDistX, stepsX),
+                                               _mm256_castsi256_ps(hit));
+                hitCellX = _mm256_blendv_epi8(hitCellX, cellX, hit);
+                hitCellY = _mm256_blendv_epi8(hitCellY, cellY, hit);
+                hitSide = _mm256_blendv_epi8(hitSide, _mm256_blendv_epi8(horizontal, vertical, stepsXi), hit);
+
+                active = _mm256_andnot_si256(wall, active);
+
+                const __m256 nextX = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(cellX, edgeX)), rayOriginX), invDirX);
+                const __m256 nextY = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(cellY, edgeY)), rayOriginY), invDirY);
+                sideDistX = _mm256_blendv_ps(sideDistX, nextX, stepsX);
+                sideDistY = _mm256_blendv_ps(nextY, sideDistY, stepsX);
+            }
+
+            alignas(32) float distance[LANES];
+            alignas(32) int resultX[LANES];
+            alignas(32) int resultY[LANES];
+            alignas(32) int side[LANES];
+            _mm256_store_ps(distance, hitDistance);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(resultX), hitCellX);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(resultY), hitCellY);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(side), hitSide);
+
+            storeHits(distance, resultX, resultY, side, count, hits);
+        }
+    }
+
+    bool isSupported(const Kernel kernel)
+    {
+        static const bool hasAvx2 = cpuHasAvx2();
+
+        switch (kernel)
+        {
+        case Kernel::Avx2:
+            return hasAvx2;
+        default:
+            return true;
+        }
+    }
+
+    void castSse2(const world::Map& map, const float originX, const float originY,
+                  const float* dirX, const float* dirY, const int count, RayHit* hits,
+                  const float maxDistance)
+    {
+        for (int i = 0; i < count; i += 4)
+            castGroupSse2(map, originX, originY, dirX + i, dirY + i, std::min(4, count - i), hits + i, maxDistance);
+    }
+
+    void castAvx2(const world::Map& map, const float originX, const float originY,
+                  const float* dirX, const float* dirY, const int count, RayHit* hits,
+                  const float maxDistance)
+    {
+        for (int i = 0; i < count; i += 8)
+            castGroupAvx2(map, originX, originY, dirX + i, dirY + i, std::min(8, count - i), hits + i, maxDistance);
+    }
+}
+
+#endif
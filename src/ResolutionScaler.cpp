@@ -0,0 +1,38 @@
+#include "ResolutionScaler.h"
+
+namespace rendering
+{
+    namespace
+    {
+        // Weight of each new frame time in the average, enough to ride out a single slow frame.
+        constexpr double SMOOTHING = 0.1;
+    }
+
+    ResolutionScaler::ResolutionScaler(const std::span<const RenderResolution> resolutions,
+                                       const double targetSeconds)
+        : resolutions(resolutions.begin(), resolutions.end()), targetSeconds(targetSeconds)
+    {
+    }
+
+    bool ResolutionScaler::update(const double frameSeconds)
+    {
+        // The average restarts at each step, so it only ever holds frames drawn at this resolution.
+        averageSeconds = frames == 0 ? frameSeconds : averageSeconds + (frameSeconds - averageSeconds) * SMOOTHING;
+        frames++;
+
+        if (frames < SETTLE_FRAMES)
+            return false;
+
+        const int last = static_cast<int>(resolutions.size()) - 1;
+
+        if (averageSeconds > targetSeconds * STEP_DOWN_FRACTION && step < last)
+            step++;
+        else if (averageSeconds < targetSeconds * STEP_UP_FRACTION && step > 0)
+            step--;
+        else
+            return false;
+
+        frames = 0;
+        return true;
+    }
+}
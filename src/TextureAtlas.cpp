@@ -0,0 +1,165 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace rendering
+{
+    namespace
+    {
+        constexpr int RAMP_SIZE = 64;
+
+        // The first index of each ramp in the default palette.
+        constexpr int GREY = 0;
+        constexpr int RED = 64;
+        constexpr int BLUE = 128;
+        constexpr int BROWN = 192;
+
+        // A repeatable hash of a texel, for surface noise.
+        int noise(const int x, const int y, const int seed, const int range)
+        {
+            std::uint32_t hash = static_cast<std::uint32_t>(x) * 374761393u + static_cast<std::uint32_t>(y) * 668265263u
+                                 + static_cast<std::uint32_t>(seed) * 2246822519u;
+            hash = (hash ^ (hash >> 13)) * 1274126177u;
+            return static_cast<int>((hash ^ (hash >> 16)) % static_cast<std::uint32_t>(2 * range + 1)) - range;
+        }
+
+        std::uint8_t shadeOf(const int ramp, const int brightness)
+        {
+            return static_cast<std::uint8_t>(ramp + std::clamp(brightness, 0, RAMP_SIZE - 1));
+        }
+
+        // Each generator returns the texel at (x, y) of a TEXTURE_SIZE texture.
+        template <typename Texel>
+        std::vector<std::uint8_t> drawTexture(const Texel& texel)
+        {
+            constexpr int SIZE = TextureAtlas::TEXTURE_SIZE;
+            std::vector<std::uint8_t> rows(SIZE * SIZE);
+
+            for (int y = 0; y < SIZE; y++)
+            {
+                for (int x = 0; x < SIZE; x++)
+                    rows[y * SIZE + x] = texel(x, y);
+            }
+
+            return rows;
+        }
+    }
+
+    int TextureAtlas::add(const std::span<const std::uint8_t> rows)
+    {
+        const int index = getCount();
+        const std::size_t base = texels.size();
+        texels.resize(base + TEXTURE_SIZE * TEXTURE_SIZE);
+
+        for (int y = 0; y < TEXTURE_SIZE; y++)
+        {
+            for (int x = 0; x < TEXTURE_SIZE; x++)
+                texels[base + (x << TEXTURE_SHIFT) + y] = rows[(y << TEXTURE_SHIFT) + x];
+        }
+
+        return index;
+    }
+
+    int TextureAtlas::textureOffset(const int material) const
+    {
+        const int texture = std::max(material - 1, 0) % getCount();
+        return texture << (2 * TEXTURE_SHIFT);
+    }
+
+    int TextureAtlas::columnOffset(const int material, const float u) const
+    {
+        const int column = std::min(static_cast<int>(u * TEXTURE_SIZE), TEXTURE_SIZE - 1);
+        return textureOffset(material) + (column << TEXTURE_SHIFT);
+    }
+
+    Palette createDefaultPalette()
+    {
+        constexpr Colour FULL[] = {{255, 255, 255}, {200, 72, 52}, {84, 120, 196}, {172, 124, 72}};
+
+        Palette palette{};
+
+        for (int ramp = 0; ramp < 4; ramp++)
+        {
+            for (int i = 0; i < RAMP_SIZE; i++)
+            {
+                const auto scale = [&](const std::uint8_t channel)
+                {
+                    return static_cast<std::uint8_t>(channel * (i + 1) / RAMP_SIZE);
+                };
+
+                const Colour& full = FULL[ramp];
+                palette[ramp * RAMP_SIZE + i] = {scale(full.r), scale(full.g), scale(full.b)};
+            }
+        }
+
+        return palette;
+    }
+
+    TextureAtlas createDefaultTextures()
+    {
+        TextureAtlas atlas;
+
+        // Red brick in courses of 16, with every other course offset by half a brick.
+        atlas.add(drawTexture([](const int x, const int y)
+        {
+            const int course = y / 16;
+            const bool isMortar = y % 16 == 15 || (x + (course % 2) * 16) % 32 == 31;
+
+            return isMortar ? shadeOf(GREY, 28 + noise(x, y, 1, 3)) : shadeOf(RED, 44 + noise(x, y, 2, 6));
+        }));
+
+        // Grey stone blocks, lit from the top left.
+        atlas.add(drawTexture([](const int x, const int y)
+        {
+            const int blockX = x % 32;
+            const int blockY = y % 32;
+            int brightness = 40 + noise(x / 2, y / 2, 3, 4);
+
+            if (blockX == 0 || blockY == 0)
+                brightness = 56;
+            else if (blockX == 31 || blockY == 31)
+                brightness = 20;
+
+            return shadeOf(GREY, brightness + noise(x, y, 4, 2));
+        }));
+
+        // Blue tiles with dark grout.
+        atlas.add(drawTexture([](const int x, const int y)
+        {
+            const bool isGrout = x % 16 == 0 || y % 16 == 0;
+            return isGrout ? shadeOf(BLUE, 12) : shadeOf(BLUE, 48 + noise(x / 4, y / 4, 5, 3) + noise(x, y, 6, 2));
+        }));
+
+        // Vertical wooden planks with a streaked grain.
+        atlas.add(drawTexture([](const int x, const int y)
+        {
+            const bool isGap = x % 16 == 0;
+            return isGap ? shadeOf(BROWN, 14) : shadeOf(BROWN, 42 + noise(x, y / 8, 7, 5) + noise(x, y, 8, 2));
+        }));
+
+        return atlas;
+    }
+
+    std::uint8_t nearestColour(const Palette& palette, const Colour colour)
+    {
+        int nearest = 0;
+        int nearestDistance = INT_MAX;
+
+        for (int i = 0; i < static_cast<int>(palette.size()); i++)
+        {
+            const int r = palette[i].r - colour.r;
+            const int g = palette[i].g - colour.g;
+            const int b = palette[i].b - colour.b;
+            const int distance = r * r + g * g + b * b;
+
+            if (distance < nearestDistance)
+            {
+                nearest = i;
+                nearestDistance = distance;
+            }
+        }
+
+        return static_cast<std::uint8_t>(nearest);
+    }
+}
@@ -0,0 +1,147 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace util
+{
+    namespace
+    {
+        // The pool whose chunk this thread is running, if any.
+        thread_local const ThreadPool* runningPool{nullptr};
+    }
+
+    ThreadPool::ThreadPool(const unsigned threadCount)
+    {
+        start(threadCount);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        stop();
+    }
+
+    void ThreadPool::setThreadCount(const unsigned threadCount)
+    {
+        stop();
+        start(threadCount);
+    }
+
+    void ThreadPool::run(const int chunkCount, const std::function<void(int chunk)>& job)
+    {
+        if (chunkCount <= 0)
+            return;
+
+        // Nothing to hand off, so skip the wake-up entirely. A job calling back into its own pool
+        // would overwrite the running job and wait on itself, so nested runs stay on this thread.
+        if (workers.empty() || chunkCount == 1 || runningPool == this)
+        {
+            for (int i = 0; i < chunkCount; i++)
+                job(i);
+
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            this->job = &job;
+            this->chunkCount = chunkCount;
+            nextChunk = 0;
+            chunksDone = 0;
+            generation++;
+        }
+
+        wake.notify_all();
+
+        runChunks();
+
+        std::unique_lock lock(mutex);
+        finished.wait(lock, [this] { return chunksDone == this->chunkCount; });
+        this->job = nullptr;
+    }
+
+    void ThreadPool::start(unsigned threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        stopping = false;
+
+        // The calling thread is the first member of the pool.
+        for (unsigned i = 1; i < threadCount; i++)
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    void ThreadPool::stop()
+    {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+
+        wake.notify_all();
+
+        for (std::thread& worker : workers)
+            worker.join();
+
+        workers.clear();
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        unsigned seenGeneration = 0;
+
+        {
+            std::lock_guard lock(mutex);
+            seenGeneration = generation;
+        }
+
+        while (true)
+        {
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+
+                if (stopping)
+                    return;
+
+                seenGeneration = generation;
+            }
+
+            runChunks();
+        }
+    }
+
+    void ThreadPool::runChunks()
+    {
+        while (true)
+        {
+            int chunk;
+            const std::function<void(int)>* currentJob;
+
+            {
+                std::lock_guard lock(mutex);
+
+                if (job == nullptr || nextChunk >= chunkCount)
+                    return;
+
+                chunk = nextChunk++;
+                currentJob = job;
+            }
+
+            const ThreadPool* const outerPool = runningPool;
+            runningPool = this;
+            (*currentJob)(chunk);
+            runningPool = outerPool;
+
+            bool isLast;
+
+            {
+                std::lock_guard lock(mutex);
+                isLast = ++chunksDone == chunkCount;
+            }
+
+            if (isLast)
+                finished.notify_one();
+        }
+    }
+}
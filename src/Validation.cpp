@@ -0,0 +1,467 @@
+#include "Validation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <thread>
+
+#include "ChunkedMap.h"
+#include "Fixed.h"
+
+namespace raycasting::validation
+{
+    namespace
+    {
+        // Float casters only disagree with the reference on rays grazing a corner closely enough that
+        // rounding decides which cell they enter, and their distances stay within a few float ulps.
+        constexpr double FLOAT_MISMATCHES_PER_MILLION = 10.0;
+        constexpr double FLOAT_DISTANCE_ERROR = 1e-3;
+
+        // The fixed point walk adds a 16.16 tangent per cell, so its rounding grows with the ray's length.
+        constexpr double FIXED_MISMATCHES_PER_MILLION = 500.0;
+        constexpr double FIXED_DISTANCE_ERROR = 0.05;
+
+        // Along a single set of grid lines, the first wall the ray enters through one of them.
+        ReferenceHit castAcross(const world::Map& map, const double originX, const double originY,
+                                const double dirX, const double dirY, const HitSide side)
+        {
+            const ReferenceHit miss{std::numeric_limits<double>::max(), -1, -1, HitSide::None};
+
+            // Treat horizontal lines as vertical ones with the axes swapped.
+            const bool isVertical = side == HitSide::Vertical;
+            const double along = isVertical ? dirX : dirY;
+            const double across = isVertical ? dirY : dirX;
+            const double start = isVertical ? originX : originY;
+            const double offset = isVertical ? originY : originX;
+
+            if (along == 0.0)
+                return miss;
+
+            const int step = along > 0.0 ? 1 : -1;
+            int line = static_cast<int>(std::floor(start)) + (step > 0 ? 1 : 0);
+
+            while (true)
+            {
+                const double distance = (line - start) / along;
+                const int cell = step > 0 ? line : line - 1;
+                const int crossCell = static_cast<int>(std::floor(offset + distance * across));
+
+                const int cellX = isVertical ? cell : crossCell;
+                const int cellY = isVertical ? crossCell : cell;
+
+                // Once the ray leaves the map through any edge, it can't find a wall along these lines.
+                if (!map.isInside(cellX, cellY))
+                    return miss;
+
+                if (map.isWall(cellX, cellY))
+                    return {distance, cellX, cellY, side};
+
+                line += step;
+            }
+        }
+
+        // The reference direction for a fine angle, snapped on the axes like the lookup tables.
+        void referenceDirection(const maths::BinaryAngle angle, double& dirX, double& dirY)
+        {
+            const int fine = maths::toFineAngle(angle);
+            const double radians = fine * (2.0 * std::numbers::pi / maths::FINE_ANGLES);
+
+            dirX = (fine + maths::FINE_ANGLES / 4) % (maths::FINE_ANGLES / 2) == 0 ? 0.0 : std::cos(radians);
+            dirY = fine % (maths::FINE_ANGLES / 2) == 0 ? 0.0 : std::sin(radians);
+        }
+
+        world::Map makeMap(const int width, const int height, const int wallOneIn, const bool hasBorder,
+                           std::mt19937& random)
+        {
+            std::vector<int> cells(static_cast<std::size_t>(width) * height, 0);
+
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width; x++)
+                {
+                    const bool isBorder = hasBorder && (x == 0 || y == 0 || x == width - 1 || y == height - 1);
+
+                    if (isBorder || random() % wallOneIn == 0)
+                        cells[static_cast<std::size_t>(y) * width + x] = 1 + static_cast<int>(random() % 3);
+                }
+            }
+
+            return {width, height, cells};
+        }
+
+        // Updates the chunked map's residency with the player standing still until isDone, or gives up
+        // after a few seconds. Returns whether isDone was reached.
+        template <typename Predicate>
+        bool settle(world::ChunkedMap& chunked, const float x, const float y, const Predicate& isDone)
+        {
+            constexpr int MAX_UPDATES = 5000;
+
+            for (int update = 0; update < MAX_UPDATES; update++)
+            {
+                chunked.updateResidency(x, y, 1.0f, 0.0f);
+
+                if (isDone())
+                    return true;
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            return false;
+        }
+
+        // Whether every chunk of the map within the load radius of a position has been installed.
+        bool isLoadedAround(const world::ChunkedMap& chunked, const float x, const float y)
+        {
+            constexpr int REACH = world::ChunkedMap::LOAD_RADIUS * world::ChunkedMap::CHUNK_SIZE;
+
+            for (int cellY = static_cast<int>(y) - REACH; cellY <= static_cast<int>(y) + REACH; cellY += world::ChunkedMap::CHUNK_SIZE)
+            {
+                for (int cellX = static_cast<int>(x) - REACH; cellX <= static_cast<int>(x) + REACH; cellX += world::ChunkedMap::CHUNK_SIZE)
+                {
+                    if (chunked.isInside(cellX, cellY) && !chunked.chunkAt(cellX, cellY).isResident)
+                        return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Error totals for the hits that matched the reference, for the mean.
+        struct ErrorSum
+        {
+            double total{0.0};
+            long count{0};
+        };
+
+        void compare(CasterReport& report, ErrorSum& errorSum, const ReferenceHit& expected,
+                     const double distance, const int cellX, const int cellY, const HitSide side)
+        {
+            report.rays++;
+
+            const bool isHit = side != HitSide::None;
+
+            if (isHit != (expected.side != HitSide::None))
+            {
+                report.wrongHits++;
+                return;
+            }
+
+            if (!isHit)
+                return;
+
+            if (cellX != expected.cellX || cellY != expected.cellY)
+            {
+                report.wrongCells++;
+                return;
+            }
+
+            if (side != expected.side)
+            {
+                report.wrongSides++;
+                return;
+            }
+
+            const double error = std::abs(distance - expected.distance);
+            report.maxDistanceError = std::max(report.maxDistanceError, error);
+            errorSum.total += error;
+            errorSum.count++;
+        }
+    }
+
+    ReferenceHit castReference(const world::Map& map, const double originX, const double originY,
+                               const double dirX, const double dirY)
+    {
+        const ReferenceHit vertical = castAcross(map, originX, originY, dirX, dirY, HitSide::Vertical);
+        const ReferenceHit horizontal = castAcross(map, originX, originY, dirX, dirY, HitSide::Horizontal);
+
+        // Through an exact corner the DDA walk crosses the horizontal line first.
+        return vertical.distance < horizontal.distance ? vertical : horizontal;
+    }
+
+    bool CasterReport::isAccurate() const
+    {
+        if (!isExact)
+            return true;
+
+        const double mismatches = static_cast<double>(wrongHits + wrongCells + wrongSides);
+        return mismatches * 1e6 <= allowedMismatchesPerMillion * static_cast<double>(rays)
+               && maxDistanceError <= allowedDistanceError;
+    }
+
+    std::vector<world::Map> makeMaps(const unsigned seed)
+    {
+        std::mt19937 random(seed);
+
+        std::vector<world::Map> maps;
+        maps.push_back(makeMap(13, 13, 6, true, random));
+        maps.push_back(makeMap(64, 48, 12, true, random));
+        maps.push_back(makeMap(200, 300, 60, false, random));
+        maps.push_back(makeMap(1024, 1024, 400, true, random));
+        return maps;
+    }
+
+    std::vector<CasterReport> run(const std::vector<world::Map>& maps, const std::span<const maths::BinaryAngle> columnAngles,
+                                  const int posesPerMap, const unsigned seed)
+    {
+        // Widest span castRaysCoherent resolves from its ends, as the renderer uses it.
+        constexpr int SPAN_COLUMNS = 4;
+
+        const Kernel kernels[] = {Kernel::Scalar, Kernel::Sse2, Kernel::Avx2};
+        const char* kernelNames[] = {"castRays scalar", "castRays sse2", "castRays avx2"};
+
+        enum Caster { CAST, CAST_RAYS, COHERENT = CAST_RAYS + 3, FIXED, CASTER_COUNT };
+
+        std::vector<CasterReport> reports(CASTER_COUNT);
+        std::vector<ErrorSum> errorSums(CASTER_COUNT);
+
+        for (CasterReport& report : reports)
+        {
+            report.allowedMismatchesPerMillion = FLOAT_MISMATCHES_PER_MILLION;
+            report.allowedDistanceError = FLOAT_DISTANCE_ERROR;
+        }
+
+        reports[CAST].caster = "cast";
+        reports[COHERENT].caster = "castRaysCoherent";
+        reports[COHERENT].isExact = false;
+        reports[FIXED].caster = "castFixed";
+        reports[FIXED].allowedMismatchesPerMillion = FIXED_MISMATCHES_PER_MILLION;
+        reports[FIXED].allowedDistanceError = FIXED_DISTANCE_ERROR;
+
+        for (int k = 0; k < 3; k++)
+            reports[CAST_RAYS + k].caster = kernelNames[k];
+
+        const std::size_t columns = columnAngles.size();
+        std::vector<float> dirX(columns);
+        std::vector<float> dirY(columns);
+        std::vector<RayHit> hits(columns);
+        std::vector<ReferenceHit> expected(columns);
+
+        std::mt19937 random(seed);
+
+        for (const world::Map& map : maps)
+        {
+            Raycaster raycaster(map);
+
+            for (int pose = 0; pose < posesPerMap; pose++)
+            {
+                int cellX;
+                int cellY;
+
+                do
+                {
+                    cellX = static_cast<int>(random() % map.getWidth());
+                    cellY = static_cast<int>(random() % map.getHeight());
+                }
+                while (map.isWall(cellX, cellY));
+
+                std::uniform_real_distribution<float> fraction(0.0f, 1.0f);
+                const float originX = static_cast<float>(cellX) + fraction(random);
+                const float originY = static_cast<float>(cellY) + fraction(random);
+                const auto viewAngle = static_cast<maths::BinaryAngle>(random());
+
+                for (std::size_t i = 0; i < columns; i++)
+                {
+                    const auto angle = static_cast<maths::BinaryAngle>(viewAngle + columnAngles[i]);
+
+                    double referenceX;
+                    double referenceY;
+                    referenceDirection(angle, referenceX, referenceY);
+                    expected[i] = castReference(map, originX, originY, referenceX, referenceY);
+
+                    dirX[i] = maths::fineCos(angle);
+                    dirY[i] = maths::fineSin(angle);
+
+                    const RayHit hit = raycaster.cast(originX, originY, dirX[i], dirY[i]);
+                    compare(reports[CAST], errorSums[CAST], expected[i], hit.distance, hit.cellX, hit.cellY, hit.side);
+
+                    const FixedRayHit fixedHit = raycaster.castFixed(maths::Fixed{originX}, maths::Fixed{originY}, angle);
+                    compare(reports[FIXED], errorSums[FIXED], expected[i], static_cast<float>(fixedHit.distance),
+                            fixedHit.cellX, fixedHit.cellY, fixedHit.side);
+                }
+
+                for (int k = 0; k < 3; k++)
+                {
+                    // Kernels the CPU lacks fall back to another one, which is already covered.
+                    raycaster.setKernel(kernels[k]);
+
+                    if (raycaster.getKernel() != kernels[k])
+                        continue;
+
+                    raycaster.castRays(originX, originY, dirX, dirY, hits);
+
+                    for (std::size_t i = 0; i < columns; i++)
+                        compare(reports[CAST_RAYS + k], errorSums[CAST_RAYS + k], expected[i],
+                                hits[i].distance, hits[i].cellX, hits[i].cellY, hits[i].side);
+                }
+
+                raycaster.castRaysCoherent(originX, originY, dirX, dirY, hits, SPAN_COLUMNS);
+
+                for (std::size_t i = 0; i < columns; i++)
+                    compare(reports[COHERENT], errorSums[COHERENT], expected[i],
+                            hits[i].distance, hits[i].cellX, hits[i].cellY, hits[i].side);
+            }
+        }
+
+        for (int i = 0; i < CASTER_COUNT; i++)
+        {
+            if (errorSums[i].count > 0)
+                reports[i].meanDistanceError = errorSums[i].total / static_cast<double>(errorSums[i].count);
+        }
+
+        // Unsupported kernels cast nothing, so they aren't reported.
+        std::erase_if(reports, [](const CasterReport& report) { return report.rays == 0; });
+
+        return reports;
+    }
+
+    std::vector<std::string> checkChunkedMap(const std::string& path, const unsigned seed)
+    {
+        constexpr int CHUNK_SIZE = world::ChunkedMap::CHUNK_SIZE;
+        constexpr int RAYS = 20000;
+
+        // Five by four chunks, all within the load radius of the middle one. The eviction budget holds
+        // the chunks around one corner and no more, so walking to the other corner has to evict.
+        constexpr int FULL_BUDGET = 64;
+        constexpr int EVICTION_BUDGET = 9;
+        constexpr int READABLE_CHUNKS = 7;
+
+        // The file's magic and its width and height, ahead of the chunks.
+        constexpr std::uintmax_t HEADER_SIZE = 8 + 2 * sizeof(std::int32_t);
+
+        std::mt19937 random(seed);
+        const world::Map map = makeMap(300, 200, 8, false, random);
+        const Raycaster raycaster(map);
+
+        const auto writeMap = [&]
+        {
+            return world::ChunkedMap::write(path, map.getWidth(), map.getHeight(),
+                                            [&](const int x, const int y) { return map.materialAt(x, y); });
+        };
+
+        const int chunkCount = ((map.getWidth() + CHUNK_SIZE - 1) / CHUNK_SIZE) * ((map.getHeight() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        const float middleX = static_cast<float>(map.getWidth()) * 0.5f;
+        const float middleY = static_cast<float>(map.getHeight()) * 0.5f;
+
+        std::vector<std::string> failures;
+
+        if (!writeMap())
+            return {"couldn't write " + path};
+
+        // Every cell and every cast of the fully loaded map match the map it was written from.
+        if (const std::unique_ptr<world::ChunkedMap> chunked = world::ChunkedMap::open(path, FULL_BUDGET))
+        {
+            if (!settle(*chunked, middleX, middleY, [&] { return chunked->getResidentCount() == chunkCount; }))
+                failures.push_back("only " + std::to_string(chunked->getResidentCount()) + " of "
+                                   + std::to_string(chunkCount) + " chunks became resident");
+
+            long wrongCells = 0;
+
+            for (int y = 0; y < map.getHeight(); y++)
+            {
+                for (int x = 0; x < map.getWidth(); x++)
+                {
+                    if (chunked->isWall(x, y) != map.isWall(x, y) || chunked->materialAt(x, y) != map.materialAt(x, y))
+                        wrongCells++;
+                }
+            }
+
+            if (wrongCells > 0)
+                failures.push_back(std::to_string(wrongCells) + " cells read back differently");
+
+            const ChunkedRaycaster chunkedRaycaster(*chunked);
+            std::uniform_real_distribution<float> fraction(0.0f, 1.0f);
+            long wrongHits = 0;
+
+            for (int ray = 0; ray < RAYS; ray++)
+            {
+                int cellX;
+                int cellY;
+
+                do
+                {
+                    cellX = static_cast<int>(random() % map.getWidth());
+                    cellY = static_cast<int>(random() % map.getHeight());
+                }
+                while (map.isWall(cellX, cellY));
+
+                const float originX = static_cast<float>(cellX) + fraction(random);
+                const float originY = static_cast<float>(cellY) + fraction(random);
+                const auto angle = static_cast<maths::BinaryAngle>(random());
+
+                const RayHit expected = raycaster.cast(originX, originY, maths::fineCos(angle), maths::fineSin(angle));
+                const RayHit hit = chunkedRaycaster.cast(originX, originY, maths::fineCos(angle), maths::fineSin(angle));
+
+                if (hit.side != expected.side || hit.cellX != expected.cellX || hit.cellY != expected.cellY
+                    || hit.distance != expected.distance)
+                    wrongHits++;
+            }
+
+            if (wrongHits > 0)
+                failures.push_back(std::to_string(wrongHits) + " of " + std::to_string(RAYS)
+                                   + " chunked casts differ from Raycaster::cast");
+        }
+        else
+        {
+            failures.push_back("couldn't open " + path);
+        }
+
+        // Walking from one corner to the other stays within budget and evicts the chunks left behind.
+        if (const std::unique_ptr<world::ChunkedMap> chunked = world::ChunkedMap::open(path, EVICTION_BUDGET))
+        {
+            const float startX = CHUNK_SIZE * 0.5f;
+            const float startY = CHUNK_SIZE * 0.5f;
+            const float endX = static_cast<float>(map.getWidth()) - 0.5f;
+            const float endY = static_cast<float>(map.getHeight()) - 0.5f;
+
+            settle(*chunked, startX, startY, [&] { return isLoadedAround(*chunked, startX, startY); });
+            const unsigned revision = chunked->getRevision();
+
+            if (!settle(*chunked, endX, endY, [&] { return isLoadedAround(*chunked, endX, endY); }))
+                failures.push_back("the chunks around the far corner never became resident");
+
+            if (chunked->getResidentCount() > EVICTION_BUDGET)
+                failures.push_back(std::to_string(chunked->getResidentCount()) + " chunks resident over a budget of "
+                                   + std::to_string(EVICTION_BUDGET));
+
+            if (chunked->chunkAt(0, 0).isResident || !chunked->isWall(0, 0) || chunked->materialAt(0, 0) != 0)
+                failures.push_back("the chunk left behind was not evicted");
+
+            if (chunked->getRevision() == revision)
+                failures.push_back("the revision didn't change as chunks came and went");
+        }
+
+        // Chunks past the end of a truncated file stay out, and come in once the file is whole again.
+        std::filesystem::resize_file(path, HEADER_SIZE + static_cast<std::uintmax_t>(READABLE_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE);
+
+        if (const std::unique_ptr<world::ChunkedMap> chunked = world::ChunkedMap::open(path, FULL_BUDGET))
+        {
+            // Long enough for the unreadable chunks to fail more than once.
+            constexpr int FAILING_UPDATES = 3 * world::ChunkedMap::READ_RETRY_FRAMES;
+
+            int updates = 0;
+            settle(*chunked, middleX, middleY, [&] { return ++updates >= FAILING_UPDATES; });
+
+            if (chunked->getResidentCount() != READABLE_CHUNKS)
+                failures.push_back(std::to_string(chunked->getResidentCount()) + " chunks resident from a file holding "
+                                   + std::to_string(READABLE_CHUNKS));
+
+            writeMap();
+
+            if (!settle(*chunked, middleX, middleY, [&] { return chunked->getResidentCount() == chunkCount; }))
+                failures.push_back("chunks that failed to read were not retried");
+        }
+        else
+        {
+            failures.push_back("couldn't open the truncated " + path);
+        }
+
+        std::error_code error;
+        std::filesystem::remove(path, error);
+
+        return failures;
+    }
+}
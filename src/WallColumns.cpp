@@ -0,0 +1,177 @@
+#include "WallColumns.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RAYCASTER_PROJECT_SSE2 1
+#endif
+
+namespace rendering
+{
+    namespace
+    {
+        // Keeps the V step of a miss, at FLT_MAX distance, inside 16.16.
+        constexpr float MAX_V_STEP = 1 << 30;
+
+        // Draws the walls into a framebuffer of any pixel type, with levels giving the shaded pixels of a
+        // light level indexed by texel.
+        template <typename Pixel, typename Levels>
+        void drawWallPixels(BasicFramebuffer<Pixel>& framebuffer, const WallColumns& columns, const TextureAtlas& atlas,
+                            const Levels& levels, const int columnWidth)
+        {
+            const std::uint8_t* texels = atlas.getTexels().data();
+
+            for (int i = 0; i < columns.size(); i++)
+            {
+                const int top = columns.getTops()[i];
+                const int bottom = columns.getBottoms()[i];
+
+                if (top >= bottom)
+                    continue;
+
+                const std::uint8_t* texelColumn = texels + columns.getTexelColumns()[i];
+                const Pixel* shaded = levels(columns.getLightLevels()[i]);
+                const std::uint32_t vStep = columns.getTextureVSteps()[i];
+                std::uint32_t v = columns.getTextureV()[i];
+
+                // The framebuffer is column-major, so the wall is one contiguous run per screen column.
+                Pixel* first = framebuffer.column(i * columnWidth);
+
+                for (int y = top; y < bottom; y++, v += vStep)
+                    first[y] = shaded[texelColumn[(v >> 16) & (TextureAtlas::TEXTURE_SIZE - 1)]];
+
+                // The rest of a wide column is a copy of its first.
+                for (int x = 1; x < columnWidth; x++)
+                    std::memcpy(framebuffer.column(i * columnWidth + x) + top, first + top,
+                                static_cast<std::size_t>(bottom - top) * sizeof(Pixel));
+            }
+        }
+    }
+
+    void WallColumns::resize(const int columns)
+    {
+        if (columns == size())
+            return;
+
+        tops.resize(columns);
+        bottoms.resize(columns);
+        lightLevels.resize(columns);
+        texelColumns.resize(columns);
+        textureV.resize(columns);
+        textureVSteps.resize(columns);
+    }
+
+    void WallColumns::project(const HitBuffer& hits, const Projection& projection, const TextureAtlas& atlas)
+    {
+        const float* distances = hits.getDistances().data();
+        const float* inverseDistances = hits.getInverseDistances().data();
+        const raycasting::HitSide* sides = hits.getSides().data();
+
+        const float screenHeight = static_cast<float>(projection.screenHeight);
+        const float centre = screenHeight * 0.5f;
+        const float halfScale = projection.heightScale * 0.5f;
+        const float inverseFog = 1.0f / projection.fogDistance;
+
+        // A wall's full height covers the texture once, so V steps by this times the distance per row.
+        const float textureScale = static_cast<float>(TextureAtlas::TEXTURE_SIZE << 16) / projection.heightScale;
+
+        const int count = std::min(size(), hits.size());
+        int i = 0;
+
+#ifdef RAYCASTER_PROJECT_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 screenHeights = _mm_set1_ps(screenHeight);
+        const __m128 centres = _mm_set1_ps(centre);
+        const __m128 halfScales = _mm_set1_ps(halfScale);
+        const __m128 fog = _mm_set1_ps(projection.fogDistance);
+        const __m128 inverseFogs = _mm_set1_ps(inverseFog);
+        const __m128 horizontalLight = _mm_set1_ps(HORIZONTAL_SHADE * Colormap::LEVELS_PER_BRIGHTNESS);
+        const __m128 verticalLight = _mm_set1_ps(VERTICAL_SHADE * Colormap::LEVELS_PER_BRIGHTNESS);
+        const __m128i horizontal = _mm_set1_epi32(static_cast<int>(raycasting::HitSide::Horizontal));
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 textureScales = _mm_set1_ps(textureScale);
+        const __m128 maxVStep = _mm_set1_ps(MAX_V_STEP);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 distance = _mm_loadu_ps(distances + i);
+
+            // Walls past the fog get no height, so they cover no rows.
+            const __m128 isVisible = _mm_cmple_ps(distance, fog);
+            const __m128 inverseDistance = _mm_loadu_ps(inverseDistances + i);
+            const __m128 halfHeight = _mm_and_ps(_mm_mul_ps(inverseDistance, halfScales), isVisible);
+
+            // Rounding to the nearest row edge, after clipping so a very near wall can't overflow.
+            const __m128 wallTop = _mm_sub_ps(centres, halfHeight);
+            const __m128i top = _mm_cvtps_epi32(_mm_max_ps(wallTop, zero));
+            const __m128i bottom = _mm_cvtps_epi32(_mm_min_ps(_mm_add_ps(centres, halfHeight), screenHeights));
+
+            // V is sampled at row centres, so a wall clipped by the screen starts part way down its texture.
+            const __m128 vStep = _mm_min_ps(_mm_mul_ps(distance, textureScales), maxVStep);
+            const __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(_mm_cvtepi32_ps(top), half), wallTop), vStep);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(textureV.data() + i), _mm_cvttps_epi32(_mm_max_ps(v, zero)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(textureVSteps.data() + i), _mm_cvttps_epi32(vStep));
+
+            // Widen the four side bytes to a lane each.
+            std::int32_t sideBytes;
+            std::memcpy(&sideBytes, sides + i, sizeof(sideBytes));
+            const __m128i side = _mm_unpacklo_epi16(
+                _mm_unpacklo_epi8(_mm_cvtsi32_si128(sideBytes), _mm_setzero_si128()), _mm_setzero_si128());
+            const __m128 isHorizontal = _mm_castsi128_ps(_mm_cmpeq_epi32(side, horizontal));
+            const __m128 sideLight = _mm_or_ps(_mm_and_ps(isHorizontal, horizontalLight),
+                                               _mm_andnot_ps(isHorizontal, verticalLight));
+
+            // The fade can't exceed the side's light, and truncating a non-negative value floors it.
+            const __m128 fade = _mm_sub_ps(one, _mm_mul_ps(distance, inverseFogs));
+            const __m128i light = _mm_cvttps_epi32(_mm_max_ps(_mm_mul_ps(sideLight, fade), zero));
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(tops.data() + i), _mm_packs_epi32(top, top));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(bottoms.data() + i), _mm_packs_epi32(bottom, bottom));
+
+            const __m128i lightWords = _mm_packs_epi32(light, light);
+            const std::int32_t lightBytes = _mm_cvtsi128_si32(_mm_packus_epi16(lightWords, lightWords));
+            std::memcpy(lightLevels.data() + i, &lightBytes, sizeof(lightBytes));
+        }
+#endif
+
+        // The same maths for the columns left over, or every column without SSE2.
+        for (; i < count; i++)
+        {
+            const float halfHeight = distances[i] <= projection.fogDistance ? inverseDistances[i] * halfScale : 0.0f;
+            const float wallTop = centre - halfHeight;
+            tops[i] = static_cast<std::int16_t>(std::lrint(std::max(wallTop, 0.0f)));
+            bottoms[i] = static_cast<std::int16_t>(std::lrint(std::min(centre + halfHeight, screenHeight)));
+
+            const float vStep = std::min(distances[i] * textureScale, MAX_V_STEP);
+            textureV[i] = static_cast<std::uint32_t>(std::max((tops[i] + 0.5f - wallTop) * vStep, 0.0f));
+            textureVSteps[i] = static_cast<std::uint32_t>(vStep);
+
+            const int sideShade = sides[i] == raycasting::HitSide::Horizontal ? HORIZONTAL_SHADE : VERTICAL_SHADE;
+            const float sideLight = sideShade * Colormap::LEVELS_PER_BRIGHTNESS;
+            lightLevels[i] = static_cast<std::uint8_t>(std::max(sideLight * (1.0f - distances[i] * inverseFog), 0.0f));
+        }
+
+        const std::span<const std::uint8_t> materials = hits.getMaterials();
+        const std::span<const float> textureU = hits.getTextureU();
+
+        for (int column = 0; column < count; column++)
+            texelColumns[column] = atlas.columnOffset(materials[column], textureU[column]);
+    }
+
+    void drawWalls(Framebuffer& framebuffer, const WallColumns& columns, const TextureAtlas& atlas,
+                   const Colormap& colormap, const int columnWidth)
+    {
+        drawWallPixels(framebuffer, columns, atlas, [&](const int light) { return colormap.level(light); }, columnWidth);
+    }
+
+    void drawWalls(IndexedFramebuffer& framebuffer, const WallColumns& columns, const TextureAtlas& atlas,
+                   const Colormap& colormap, const int columnWidth)
+    {
+        drawWallPixels(framebuffer, columns, atlas, [&](const int light) { return colormap.indexLevel(light); },
+                       columnWidth);
+    }
+}
@@ -7,10 +7,31 @@
 #include <numbers>
 #include <cmath>
 #include <array>
+#include <span>
 #include <string>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <optional>
+#include <filesystem>
 
 #include "DeltaClock.h"
 #include "Maths.h"
+#include "Fixed.h"
+#include "Map.h"
+#include "Raycaster.h"
+#include "HitCache.h"
+#include "ThreadPool.h"
+#include "Camera.h"
+#include "HitBuffer.h"
+#include "WallColumns.h"
+#include "Validation.h"
+#include "Framebuffer.h"
+#include "TextureAtlas.h"
+#include "FloorRows.h"
+#include "Colormap.h"
+#include "ResolutionScaler.h"
+#include "Benchmark.h"
 
 namespace
 {
@@ -23,10 +44,19 @@ namespace
     SDL_Window* window{nullptr};
     SDL_Renderer* renderer{nullptr};
 
+    // The frame is drawn on the CPU and streamed into this texture once per frame.
+    SDL_Texture* frameTexture{nullptr};
+
     const bool* keyStates{nullptr};
 
     bool IS_RUNNING{true};
 
+    // Forces the next frame to render even if nothing in the scene changed, e.g. after an expose.
+    bool IS_FRAME_DIRTY{true};
+
+    // How long an idle frame sleeps waiting for input before polling again.
+    constexpr Sint32 IDLE_WAIT_MS = 16;
+
     util::DeltaClock deltaClock;
     double deltaTime{};
 
@@ -37,105 +67,170 @@ namespace
     constexpr int GRID_HEIGHT = 13;
 
     constexpr Uint8 RAY_RES = 1;
-    constexpr Uint16 NUMBER_OF_RAYS = SCREEN_WIDTH / RAY_RES;
+
+    // Resolutions drawn to hold the frame time target, sharpest first, each stretched to the screen
+    // width. Every width is a multiple of its ray resolution, so columns cover the whole frame.
+    constexpr std::array<rendering::RenderResolution, 5> RENDER_RESOLUTIONS
+    {{
+        {SCREEN_WIDTH, RAY_RES},
+        {SCREEN_WIDTH, RAY_RES * 2},
+        {SCREEN_WIDTH * 3 / 4, RAY_RES * 2},
+        {SCREEN_WIDTH / 2, RAY_RES * 2},
+        {SCREEN_WIDTH / 2, RAY_RES * 4}
+    }};
+
+    // The sharpest resolution casts the most rays, so per-column arrays are sized for it.
+    constexpr Uint16 MAX_RAYS = SCREEN_WIDTH / RAY_RES;
+
+    // Frame time the resolution is scaled to hold, by default a 120 Hz frame.
+    constexpr float FRAME_TARGET_MS = 8.3f;
+
+    // Columns are cast in chunks of a multiple of this many, which start on a cache line in the
+    // aligned direction and hit arrays. The 2- and 1-byte arrays and the heap-allocated HitBuffer
+    // can share a line with the next chunk at each end. Chunks wide enough to avoid that for bytes
+    // would leave threads idle at low resolutions.
+    constexpr int CHUNK_ALIGNMENT = 16;
+    constexpr int CHUNKS_PER_THREAD = 4;
+
+    // Widest run of columns resolved from its two end rays when they hit the same wall face. Spans
+    // only pay once columns are close enough that neighbours usually share a face: on open maps
+    // castRays is as fast below about 960 columns across the view, so narrower frames use it.
+    constexpr int SPAN_COLUMNS = 4;
+    constexpr int MIN_SPAN_FRAME_COLUMNS = 960;
+
+    // Walls fade into the fog colour by this distance, so rays stop looking for walls past it.
+    constexpr float FOG_DISTANCE = 8.0f;
+
+    // Textures of the floor and ceiling, as wall materials: stone blocks underfoot and a plank ceiling.
+    constexpr int FLOOR_MATERIAL = 2;
+    constexpr int CEILING_MATERIAL = 4;
+
+    util::ThreadPool threadPool;
 
     // Map.
-    constexpr int MAP_SIZE = GRID_WIDTH * GRID_HEIGHT;
-    const int map[GRID_HEIGHT][GRID_WIDTH] =
+    const world::Map map
     {
-        {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1},
-        {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 1},
-        {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1},
-        {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}
+        GRID_WIDTH, GRID_HEIGHT,
+        {
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1,
+            1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 0, 1, 1, 0, 0, 0, 0, 0, 1, 1, 0, 1,
+            1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+        }
     };
 
+    const raycasting::Raycaster raycaster{map};
+
+#ifdef RAYCASTER_FIXED_POINT
+    // Fixed point mode: walls are cast in 16.16 fixed point, deterministically for a given pose.
+    // Movement uses the same type but steps by the frame's wall-clock time, so poses themselves
+    // aren't reproducible.
+    using Scalar = maths::Fixed;
+
+    Scalar headingCos(const maths::BinaryAngle angle) { return maths::fixedCos(angle); }
+    Scalar headingSin(const maths::BinaryAngle angle) { return maths::fixedSin(angle); }
+#else
+    using Scalar = float;
+
+    Scalar headingCos(const maths::BinaryAngle angle) { return maths::fineCos(angle); }
+    Scalar headingSin(const maths::BinaryAngle angle) { return maths::fineSin(angle); }
+#endif
+
+#ifdef RAYCASTER_INDEXED_FRAMEBUFFER
+    // The frame is drawn in palette indices and expanded to the texture's format as it's uploaded.
+    using RenderTarget = rendering::IndexedFramebuffer;
+#else
+    using RenderTarget = rendering::Framebuffer;
+#endif
+
     // Player.
-    float playerX{1.5f};
-    float playerY{1.5f};
-    float playerDeltaX{};
-    float playerDeltaY{};
-    float playerAngle{std::numbers::pi * 0.5f};
-
-    constexpr float rotationSpeed{3.0f};
-    constexpr float moveSpeed{2.0f};
+    Scalar playerX{1.5f};
+    Scalar playerY{1.5f};
+    Scalar playerDeltaX{};
+    Scalar playerDeltaY{};
+    maths::BinaryAngle playerAngle{maths::BINARY_ANGLES / 4};
+
+    // Rotation short of a whole turn step carried between frames, so slow turns at high frame rates
+    // still add up.
+    float playerTurnRemainder{};
+
+    constexpr float rotationSpeed{3.0f * maths::BINARY_ANGLES / (2.0f * std::numbers::pi_v<float>)};
+    constexpr Scalar moveSpeed{2.0f};
 }
 
-Uint16 worldToGridCoordinate(const float worldPosition)
+int worldToGridCoordinate(const Scalar worldPosition)
 {
-    return std::floor(worldPosition);
+    return maths::floorToInt(worldPosition);
 }
 
-bool hasWallAt(const float worldX, const float worldY)
+bool hasWallAt(const Scalar worldX, const Scalar worldY)
 {
-    if (worldX < 0 || worldY < 0)
-        return false;
-
     const int tileX = worldToGridCoordinate(worldX);
     const int tileY = worldToGridCoordinate(worldY);
 
-    if (tileX + tileY > MAP_SIZE)
-        return false;
-
-    return map[tileY][tileX] == 1;
+    // isWall is unchecked and only reaches as far as the map's border, so anything outside is open.
+    return map.isInside(tileX, tileY) && map.isWall(tileX, tileY);
 }
 
-void handleMovement()
+// Turns are whole multiples of turnStep binary angles.
+void handleMovement(const int turnStep)
 {
+    const Scalar frameTime{static_cast<float>(deltaTime)};
+
     if (keyStates[SDL_SCANCODE_W])
     {
-        const float xOffset = playerDeltaX < 0 ? -0.25f : 0.25f;
-        const float yOffset = playerDeltaY < 0 ? -0.25f : 0.25f;
+        const Scalar xOffset{playerDeltaX < Scalar{} ? -0.25f : 0.25f};
+        const Scalar yOffset{playerDeltaY < Scalar{} ? -0.25f : 0.25f};
 
-        const float xOffsetPosition = playerX + xOffset;
-        const float yOffsetPosition = playerY + yOffset;
+        const Scalar xOffsetPosition = playerX + xOffset;
+        const Scalar yOffsetPosition = playerY + yOffset;
 
         if (!hasWallAt(xOffsetPosition, playerY))
-            playerX += playerDeltaX * moveSpeed * static_cast<float>(deltaTime);
+            playerX += playerDeltaX * moveSpeed * frameTime;
 
         if (!hasWallAt(playerX, yOffsetPosition))
-            playerY += playerDeltaY * moveSpeed * static_cast<float>(deltaTime);
+            playerY += playerDeltaY * moveSpeed * frameTime;
     }
 
     if (keyStates[SDL_SCANCODE_S])
     {
-        const float xOffset = playerDeltaX < 0 ? -0.25f : 0.25f;
-        const float yOffset = playerDeltaY < 0 ? -0.25f : 0.25f;
+        const Scalar xOffset{playerDeltaX < Scalar{} ? -0.25f : 0.25f};
+        const Scalar yOffset{playerDeltaY < Scalar{} ? -0.25f : 0.25f};
 
-        const float xOffsetPosition = playerX - xOffset;
-        const float yOffsetPosition = playerY - yOffset;
+        const Scalar xOffsetPosition = playerX - xOffset;
+        const Scalar yOffsetPosition = playerY - yOffset;
 
         if (!hasWallAt(xOffsetPosition, playerY))
-            playerX -= playerDeltaX * moveSpeed * static_cast<float>(deltaTime);
+            playerX -= playerDeltaX * moveSpeed * frameTime;
 
         if (!hasWallAt(playerX, yOffsetPosition))
-            playerY -= playerDeltaY * moveSpeed * static_cast<float>(deltaTime);
+            playerY -= playerDeltaY * moveSpeed * frameTime;
     }
 
     if (keyStates[SDL_SCANCODE_A])
-    {
-        playerAngle -= rotationSpeed * static_cast<float>(deltaTime);
-        playerAngle = maths::normaliseAngle(playerAngle);
-
-        playerDeltaX = std::cos(playerAngle);
-        playerDeltaY = std::sin(playerAngle);
-    }
+        playerTurnRemainder -= rotationSpeed * static_cast<float>(deltaTime);
 
     if (keyStates[SDL_SCANCODE_D])
+        playerTurnRemainder += rotationSpeed * static_cast<float>(deltaTime);
+
+    const int turn = static_cast<int>(playerTurnRemainder / static_cast<float>(turnStep)) * turnStep;
+
+    if (turn != 0)
     {
-        playerAngle += rotationSpeed * static_cast<float>(deltaTime);
-        playerAngle = maths::normaliseAngle(playerAngle);
+        playerTurnRemainder -= static_cast<float>(turn);
+        playerAngle = static_cast<maths::BinaryAngle>(playerAngle + turn);
 
-        playerDeltaX = std::cos(playerAngle);
-        playerDeltaY = std::sin(playerAngle);
+        playerDeltaX = headingCos(playerAngle);
+        playerDeltaY = headingSin(playerAngle);
     }
 }
 
@@ -146,6 +241,13 @@ void handleInput(const SDL_Event& event)
     case SDLK_ESCAPE:
         IS_RUNNING = false;
         break;
+    case SDLK_LEFTBRACKET:
+        if (threadPool.getThreadCount() > 1)
+            threadPool.setThreadCount(threadPool.getThreadCount() - 1);
+        break;
+    case SDLK_RIGHTBRACKET:
+        threadPool.setThreadCount(threadPool.getThreadCount() + 1);
+        break;
     default:
         break;
     }
@@ -163,20 +265,215 @@ void handleEvent(SDL_Event& event)
         case SDL_EVENT_KEY_DOWN:
             handleInput(event);
             break;
+        case SDL_EVENT_WINDOW_EXPOSED:
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+            IS_FRAME_DIRTY = true;
+            break;
         default:
             break;
         }
     }
 }
 
-struct Ray
+unsigned parseThreadCount(const int argc, char* argv[])
+{
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0)
+            return static_cast<unsigned>(std::max(0L, std::strtol(argv[i + 1], nullptr, 10)));
+    }
+
+    return 0;
+}
+
+float parseFogDistance(const int argc, char* argv[])
+{
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (std::strcmp(argv[i], "--fog") == 0)
+        {
+            const float distance = std::strtof(argv[i + 1], nullptr);
+            return distance > 0.0f ? distance : FOG_DISTANCE;
+        }
+    }
+
+    return FOG_DISTANCE;
+}
+
+float parseFrameTarget(const int argc, char* argv[])
+{
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (std::strcmp(argv[i], "--target-ms") == 0)
+        {
+            const float target = std::strtof(argv[i + 1], nullptr);
+            return target > 0.0f ? target : FRAME_TARGET_MS;
+        }
+    }
+
+    return FRAME_TARGET_MS;
+}
+
+bool hasFlag(const int argc, char* argv[], const char* flag)
 {
-    float distance;
-    int colour;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], flag) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+// Headless check of every caster against a double precision reference, casting this screen's columns,
+// and of a map streamed through ChunkedMap. Returns the process exit code: non-zero if any exact
+// caster strayed from the reference or the chunked map misbehaved.
+int runValidation()
+{
+    constexpr int POSES_PER_MAP = 1000;
+    constexpr unsigned SEED = 1;
+
+    rendering::ColumnTable columnTable;
+    columnTable.rebuild(SCREEN_WIDTH, RAY_RES, HFOV);
+
+    std::vector<world::Map> maps = raycasting::validation::makeMaps(SEED);
+    maps.insert(maps.begin(), map);
+
+    const std::vector<raycasting::validation::CasterReport> reports =
+        raycasting::validation::run(maps, columnTable.getAngles(), POSES_PER_MAP, SEED);
+
+    bool isAccurate = true;
+
+    std::cout << std::left << std::setw(20) << "caster" << std::right << std::setw(10) << "rays"
+              << std::setw(12) << "wrong hit" << std::setw(12) << "wrong cell" << std::setw(12) << "wrong side"
+              << std::setw(14) << "max error" << std::setw(14) << "mean error" << "\n";
+
+    for (const raycasting::validation::CasterReport& report : reports)
+    {
+        std::cout << std::left << std::setw(20) << report.caster << std::right << std::setw(10) << report.rays
+                  << std::setw(12) << report.wrongHits << std::setw(12) << report.wrongCells
+                  << std::setw(12) << report.wrongSides << std::scientific << std::setprecision(3)
+                  << std::setw(14) << report.maxDistanceError << std::setw(14) << report.meanDistanceError
+                  << std::defaultfloat << (report.isExact ? "" : "  (approximate)")
+                  << (report.isAccurate() ? "" : "  FAILED") << "\n";
+
+        isAccurate = isAccurate && report.isAccurate();
+    }
+
+    const std::string chunkedPath = (std::filesystem::temp_directory_path() / "raycaster-validation.chunks").string();
+    const std::vector<std::string> chunkedFailures = raycasting::validation::checkChunkedMap(chunkedPath, SEED);
+
+    std::cout << "\nchunked map: " << (chunkedFailures.empty() ? "ok" : "FAILED") << "\n";
+
+    for (const std::string& failure : chunkedFailures)
+        std::cout << "    " << failure << "\n";
+
+    return isAccurate && chunkedFailures.empty() ? 0 : 1;
+}
+
+// Headless timings of the casting and drawing paths against the ones they replaced, printed as tables.
+int runBenchmark()
+{
+    constexpr unsigned SEED = 1;
+
+    for (const benchmark::Table& table : benchmark::run(map, HFOV, SEED))
+    {
+        std::cout << "\n" << table.title << "\n";
+
+        // Each column is as wide as its widest cell, plus a gap.
+        std::vector<std::size_t> widths;
+
+        for (const std::string& column : table.columns)
+            widths.push_back(column.size() + 2);
+
+        for (const std::vector<std::string>& row : table.rows)
+        {
+            for (std::size_t i = 0; i < row.size() && i < widths.size(); i++)
+                widths[i] = std::max(widths[i], row[i].size() + 2);
+        }
+
+        for (std::size_t i = 0; i < table.columns.size(); i++)
+            std::cout << std::setw(static_cast<int>(widths[i])) << table.columns[i];
+
+        std::cout << "\n";
+
+        for (const std::vector<std::string>& row : table.rows)
+        {
+            for (std::size_t i = 0; i < row.size() && i < widths.size(); i++)
+                std::cout << std::setw(static_cast<int>(widths[i])) << row[i];
+
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
+
+// The renderer's preferred 32-bit packed format, so streaming the frame into a texture needs no conversion.
+SDL_PixelFormat nativePixelFormat(SDL_Renderer* renderer)
+{
+    const auto* formats = static_cast<const SDL_PixelFormat*>(SDL_GetPointerProperty(
+        SDL_GetRendererProperties(renderer), SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, nullptr));
+
+    for (; formats && *formats != SDL_PIXELFORMAT_UNKNOWN; formats++)
+    {
+        if (!SDL_ISPIXELFORMAT_FOURCC(*formats) && SDL_ISPIXELFORMAT_PACKED(*formats) && SDL_BYTESPERPIXEL(*formats) == 4)
+            return *formats;
+    }
+
+    return SDL_PIXELFORMAT_XRGB8888;
+}
+
+// Copies the finished frame into the streaming texture, the only upload of the frame. A frame drawn
+// narrower than the screen fills the texture's left edge.
+bool uploadFrame(const RenderTarget& framebuffer, const std::span<const Uint32, 256> palette)
+{
+    const SDL_Rect area{0, 0, framebuffer.getWidth(), framebuffer.getHeight()};
+    void* pixels;
+    int pitch;
+
+    if (!SDL_LockTexture(frameTexture, &area, &pixels, &pitch))
+        return false;
+
+    // The framebuffer is column-major, so it is transposed into the texture's rows as it's copied.
+#ifdef RAYCASTER_INDEXED_FRAMEBUFFER
+    framebuffer.expandRowMajor(pixels, pitch, palette);
+#else
+    static_cast<void>(palette);
+    framebuffer.copyRowMajor(pixels, pitch);
+#endif
+
+    SDL_UnlockTexture(frameTexture);
+    return true;
+}
+
+// Everything a frame's image depends on. A frame matching the last presented one is skipped.
+struct FrameState
+{
+    Scalar playerX;
+    Scalar playerY;
+    maths::BinaryAngle playerAngle;
+    unsigned mapRevision;
+    unsigned threadCount;
+    rendering::RenderResolution resolution;
+
+    bool operator==(const FrameState&) const = default;
 };
 
 int main(int argc, char* argv[])
 {
+    if (hasFlag(argc, argv, "--validate"))
+        return runValidation();
+
+    if (hasFlag(argc, argv, "--bench"))
+        return runBenchmark();
+
+    threadPool.setThreadCount(parseThreadCount(argc, argv));
+
+    const float fogDistance = parseFogDistance(argc, argv);
+
+    rendering::ResolutionScaler resolutionScaler{RENDER_RESOLUTIONS, parseFrameTarget(argc, argv) / 1000.0};
+
     if (!SDL_Init(SDL_INIT_VIDEO))
     {
         SDL_Log("SDL failed to initialise. Error: %s", SDL_GetError());
@@ -204,25 +501,120 @@ int main(int argc, char* argv[])
 
     SDL_SetRenderLogicalPresentation(renderer, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_LOGICAL_PRESENTATION_LETTERBOX);
 
+    const SDL_PixelFormat pixelFormat = nativePixelFormat(renderer);
+    frameTexture = SDL_CreateTexture(renderer, pixelFormat, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    if (!frameTexture)
+    {
+        SDL_Log("Failed to create the frame texture. Error: %s", SDL_GetError());
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return -1;
+    }
+
+    // Keep the low resolution pixels sharp when the frame is scaled up to the window.
+    SDL_SetTextureScaleMode(frameTexture, SDL_SCALEMODE_NEAREST);
+
+    // Colours packed in the texture's format, including every colour of the wall textures' palette.
+    const SDL_PixelFormatDetails* pixelDetails = SDL_GetPixelFormatDetails(pixelFormat);
+
+    const rendering::TextureAtlas wallTextures = rendering::createDefaultTextures();
+    const rendering::Palette palette = rendering::createDefaultPalette();
+    std::array<Uint32, 256> paletteColours{};
+
+    for (std::size_t i = 0; i < palette.size(); i++)
+        paletteColours[i] = SDL_MapRGB(pixelDetails, nullptr, palette[i].r, palette[i].g, palette[i].b);
+
+    // Walls, floors and ceilings are all shaded by looking their texels up at a light level.
+    const rendering::Colormap colormap{palette, paletteColours, pixelDetails->Amask};
+
+#ifdef RAYCASTER_INDEXED_FRAMEBUFFER
+    const std::uint8_t fogColour = rendering::nearestColour(palette, {0, 0, 0});
+#else
+    const Uint32 fogColour = SDL_MapRGB(pixelDetails, nullptr, 0, 0, 0);
+#endif
+
+    // Sized to the current resolution below.
+    RenderTarget framebuffer{SCREEN_WIDTH, SCREEN_HEIGHT};
+
     keyStates = SDL_GetKeyboardState(nullptr);
 
-    playerDeltaX = std::cos(playerAngle);
-    playerDeltaY = std::sin(playerAngle);
+    playerDeltaX = headingCos(playerAngle);
+    playerDeltaY = headingSin(playerAngle);
+
+    // Per-column ray directions, cast as one packet per chunk.
+    alignas(64) std::array<float, MAX_RAYS> rayDirX{};
+    alignas(64) std::array<float, MAX_RAYS> rayDirY{};
+    alignas(64) std::array<raycasting::RayHit, MAX_RAYS> hits{};
 
-    // Create and populate the ray distances array.
-    std::array<Ray, NUMBER_OF_RAYS> rays{};
-    rays.fill({std::numeric_limits<float>::max(), 255});
+#ifndef RAYCASTER_FIXED_POINT
+    // Absolute ray angles, and which columns were resolved from hits cast in earlier frames. The fixed
+    // point path casts every column, so it has no cache.
+    alignas(64) std::array<maths::BinaryAngle, MAX_RAYS> rayAngles{};
+    alignas(64) std::array<bool, MAX_RAYS> isCached{};
+    raycasting::HitCache hitCache;
+#endif
 
-    // Calculate the distance to the projection plane.
+    // Calculate the distance to the projection plane. It follows the screen rather than the width drawn,
+    // so a change of resolution only changes how many columns there are.
     const float distanceToProjectionPlane = (SCREEN_WIDTH * 0.5f) / std::tan(HFOV * 0.5f);
-    const float projectionPlaneWidth = distanceToProjectionPlane * std::tan(HFOV * 0.5f) * 2.0f;
-    const float projectionPlaneHalfWidth = projectionPlaneWidth * 0.5f;
-    constexpr int maxX = SCREEN_WIDTH - 1;
 
     const float VFOV = 2 * std::atan(std::tan(HFOV * 0.5f) * (static_cast<float>(SCREEN_HEIGHT) / static_cast<float>(SCREEN_WIDTH)));
 
     const float projectionPlaneHeight = distanceToProjectionPlane * std::tan(VFOV * 0.5f) * 2.0f;
 
+    rendering::ColumnTable columnTable;
+    rendering::HitBuffer hitBuffer;
+
+    // A wall one unit tall fills the projection plane's height at the projection plane's distance.
+    const rendering::WallColumns::Projection projection{SCREEN_HEIGHT,
+                                                        SCREEN_HEIGHT * distanceToProjectionPlane / projectionPlaneHeight,
+                                                        fogDistance};
+
+    rendering::WallColumns wallColumns;
+    rendering::FloorRows floorRows;
+
+    int renderWidth{0};
+    int rayRes{0};
+    int numberOfRays{0};
+    float maxRayDistance{0.0f};
+
+#ifdef RAYCASTER_FIXED_POINT
+    maths::Fixed fixedMaxRayDistance{};
+#endif
+
+    // Sizes everything per column or per pixel for the scaler's current resolution.
+    const auto applyResolution = [&]
+    {
+        const rendering::RenderResolution& resolution = resolutionScaler.getResolution();
+        renderWidth = resolution.width;
+        rayRes = resolution.rayRes;
+
+        columnTable.rebuild(renderWidth, rayRes, HFOV);
+        numberOfRays = columnTable.size();
+
+        hitBuffer.resize(numberOfRays);
+        wallColumns.resize(numberOfRays);
+        framebuffer = RenderTarget{renderWidth, SCREEN_HEIGHT};
+
+        // The fog is a perpendicular distance, so the edge columns see furthest along their rays. Every
+        // ray is cast this far, which keeps cached hits valid for any column that reuses them.
+        const std::span<const float> columnCosines = columnTable.getCosines();
+        maxRayDistance = fogDistance / *std::min_element(columnCosines.begin(), columnCosines.end());
+
+#ifdef RAYCASTER_FIXED_POINT
+        fixedMaxRayDistance = maths::Fixed{std::min(maxRayDistance, 32767.0f)};
+#endif
+    };
+
+    applyResolution();
+
+    std::optional<FrameState> lastFrame;
+
+    // Only the time of a loop that drew a frame says anything about the resolution.
+    bool wasFrameDrawn{false};
+
     while (IS_RUNNING)
     {
         SDL_Event event;
@@ -232,170 +624,158 @@ int main(int argc, char* argv[])
 
         deltaTime = deltaClock.tick();
 
-        handleMovement();
+        if (wasFrameDrawn && resolutionScaler.update(deltaTime))
+            applyResolution();
 
-        std::string title = "X: " + std::to_string(playerX) + " Y: " + std::to_string(playerY);
-        SDL_SetWindowTitle(window, title.c_str());
+        wasFrameDrawn = false;
 
-        // Render.
-        SDL_SetRenderDrawColorFloat(renderer, 0.0f, 0.0f, 0.0f, 0.0f);
-        SDL_RenderClear(renderer);
+        // Turning by the column angle step keeps every column on an angle the hit cache may hold.
+        handleMovement(columnTable.getAngleStep());
 
-        const float rayStartAngle = playerAngle - (HFOV * 0.5f);
-        float rayAngle = maths::normaliseAngle(rayStartAngle);
+        const FrameState frame{playerX, playerY, playerAngle, map.getRevision(), threadPool.getThreadCount(),
+                               resolutionScaler.getResolution()};
 
-        for (int i = 0; i < NUMBER_OF_RAYS; i++)
+        if (!IS_FRAME_DIRTY && lastFrame == frame)
         {
-            constexpr int maximumDepth = 20;
-            int depth = 0;
+            // Nothing visible changed, so leave the presented frame on screen and wait for input.
+            SDL_WaitEventTimeout(nullptr, IDLE_WAIT_MS);
 
-            float rayX{0};
-            float rayY{0};
+            // Don't let the time spent waiting turn into one large movement step.
+            deltaClock.tick();
+            continue;
+        }
 
-            const bool isFacingUp = rayAngle > std::numbers::pi;
-            const bool isFacingDown = !isFacingUp;
-            const bool isFacingLeft = rayAngle > 0.5f * std::numbers::pi && rayAngle < 1.5f * std::numbers::pi;
-            const bool isFacingRight = !isFacingLeft;
+        lastFrame = frame;
+        IS_FRAME_DIRTY = false;
+        wasFrameDrawn = true;
 
-            // Horizontal hit check.
-            float horizontalDistance = std::numeric_limits<float>::max();
+        std::string title = "X: " + std::to_string(static_cast<float>(playerX))
+                            + " Y: " + std::to_string(static_cast<float>(playerY))
+                            + " Threads: " + std::to_string(threadPool.getThreadCount())
+                            + " Width: " + std::to_string(renderWidth) + "/" + std::to_string(rayRes);
+        SDL_SetWindowTitle(window, title.c_str());
 
-            // The ray is looking 'up'.
-            if (isFacingUp)
-                rayY = std::floor(playerY) - 0.000001f;
-            // The ray is looking 'down'.
-            else if (isFacingDown)
-                rayY = std::floor(playerY) + 1.0f;
+        const int chunkSize = std::max(CHUNK_ALIGNMENT,
+            (numberOfRays / static_cast<int>(threadPool.getThreadCount() * CHUNKS_PER_THREAD)) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT);
+        const int chunkCount = (numberOfRays + chunkSize - 1) / chunkSize;
 
-            rayX = ((rayY - playerY) / std::tan(rayAngle)) + playerX;
+        const std::span<const maths::BinaryAngle> columnAngles = columnTable.getAngles();
+        const std::span<const float> cosines = columnTable.getCosines();
 
-            // if (rayAngle == 0.0f || rayAngle == std::numbers::pi)
-            // {
-            //     rayX = playerX;
-            //     rayY = playerY;
-            //     depth = maximumDepth;
-            // }
+#ifndef RAYCASTER_FIXED_POINT
+        hitCache.prepare(static_cast<float>(playerX), static_cast<float>(playerY), map.getRevision());
+        const bool isCastInSpans = numberOfRays >= MIN_SPAN_FRAME_COLUMNS;
+#endif
 
-            float rayYOffset = isFacingUp ? -1 : 1;
-            float rayXOffset = rayYOffset / std::tan(rayAngle);
+        threadPool.run(chunkCount, [&](const int chunk)
+        {
+            const int first = chunk * chunkSize;
+            const int count = std::min(chunkSize, numberOfRays - first);
 
-            while (depth < maximumDepth)
+#ifdef RAYCASTER_FIXED_POINT
+            for (int i = first; i < first + count; i++)
             {
-                if (hasWallAt(rayX, rayY)) // the ray hit a wall
-                {
-                    // Gte the distance to the hit point.
-                    horizontalDistance = maths::distanceBetween(playerX, playerY, rayX, rayY);
+                const auto rayAngle = static_cast<maths::BinaryAngle>(playerAngle + columnAngles[i]);
+                const raycasting::FixedRayHit hit = raycaster.castFixed(playerX, playerY, rayAngle, fixedMaxRayDistance);
 
-                    // Remove the fisheye effect for the distance.
-                    horizontalDistance *= std::cos(playerAngle - rayAngle);
-
-                    break;
-                }
-
-                rayX += rayXOffset;
-                rayY += rayYOffset;
-                depth++;
+                // Casting is deterministic; only what is drawn from the hits uses floats.
+                hits.at(i) = {static_cast<float>(hit.distance), hit.cellX, hit.cellY, hit.side};
+                rayDirX.at(i) = maths::fineCos(rayAngle);
+                rayDirY.at(i) = maths::fineSin(rayAngle);
             }
+#else
+            for (int i = first; i < first + count; i++)
+            {
+                // Adding the column's binary angle wraps around the circle for free.
+                const auto rayAngle = static_cast<maths::BinaryAngle>(playerAngle + columnAngles[i]);
 
-            // Vertical hit check.
-            float verticalDistance = std::numeric_limits<float>::max();
-
-            // The ray is looking 'right'.
-            if (isFacingRight)
-                rayX = std::floor(playerX) + 1.0f;
-            // The ray is looking 'left'.
-            else if (isFacingLeft)
-                rayX = std::floor(playerX) - 0.000001f;
+                rayAngles.at(i) = rayAngle;
 
-            rayY = playerY + (rayX - playerX) * std::tan(rayAngle);
+                // Cached columns need their direction too, for the texture U of the hit.
+                rayDirX.at(i) = maths::fineCos(rayAngle);
+                rayDirY.at(i) = maths::fineSin(rayAngle);
 
-            rayXOffset = isFacingRight ? 1 : -1;
-            rayYOffset = rayXOffset * std::tan(rayAngle);
+                const raycasting::RayHit* cached = hitCache.find(rayAngle);
+                isCached.at(i) = cached != nullptr;
 
-            // Reset the current ray depth.
-            depth = 0;
+                if (cached)
+                    hits.at(i) = *cached;
+            }
 
-            while (depth < maximumDepth)
+            // Cast the runs of columns the cache couldn't resolve, such as the edge a turn exposed.
+            for (int runStart = first; runStart < first + count;)
             {
-                if (hasWallAt(rayX, rayY)) // the ray hit a wall
+                if (isCached.at(runStart))
                 {
-                    // Gte the distance to the hit point.
-                    verticalDistance = maths::distanceBetween(playerX, playerY, rayX, rayY);
-
-                    // Remove the fisheye effect for the distance.
-                    verticalDistance *= std::cos(playerAngle - rayAngle);
-
-                    break;
+                    runStart++;
+                    continue;
                 }
 
-                rayX += rayXOffset;
-                rayY += rayYOffset;
-                depth++;
-            }
-
-            if (horizontalDistance < verticalDistance)
-            {
-                rays.at(i).distance = horizontalDistance;
-                rays.at(i).colour = 255;
-            }
-            else
-            {
-                rays.at(i).distance = verticalDistance;
-                rays.at(i).colour = 180;
-            }
+                int runEnd = runStart + 1;
 
-            // Get the current ray's screen X position.
-            const int screenX = (i + 1) * RAY_RES;
+                while (runEnd < first + count && !isCached.at(runEnd))
+                    runEnd++;
 
-            // Calculate the next ray's correct position on the projection plane for the next loop.
-            const float projectionScreenX = ((static_cast<float>(screenX * 2) - maxX) / maxX) * projectionPlaneHalfWidth;
-            const float castAngle = std::atan2f(projectionScreenX, distanceToProjectionPlane) + playerAngle;
+                const int runLength = runEnd - runStart;
+                const std::span<const float> runDirX = std::span<const float>(rayDirX).subspan(runStart, runLength);
+                const std::span<const float> runDirY = std::span<const float>(rayDirY).subspan(runStart, runLength);
+                const std::span<raycasting::RayHit> runHits = std::span(hits).subspan(runStart, runLength);
 
-            // Prepare the ray angle for the next loop.
-            rayAngle = maths::normaliseAngle(castAngle);
-        }
+                if (isCastInSpans)
+                    raycaster.castRaysCoherent(playerX, playerY, runDirX, runDirY, runHits, SPAN_COLUMNS, maxRayDistance);
+                else
+                    raycaster.castRays(playerX, playerY, runDirX, runDirY, runHits, maxRayDistance);
 
-        // Render the background
-        SDL_FRect background{0.0f, 0.0f, SCREEN_WIDTH, SCREEN_HEIGHT * 0.5f};
-        SDL_SetRenderDrawColor(renderer, 56, 56, 56, 255);
-        SDL_RenderFillRect(renderer, &background);
+                runStart = runEnd;
+            }
 
-        background.y = SCREEN_HEIGHT * 0.5f;
-        SDL_SetRenderDrawColor(renderer, 112, 112, 112, 255);
-        SDL_RenderFillRect(renderer, &background);
+#endif
 
-        SDL_FRect wallRect{0.0f, 0.0f, RAY_RES, 0.0f};
+            hitBuffer.store(first, std::span<const raycasting::RayHit>(hits).subspan(first, count),
+                            std::span<const float>(rayDirX).subspan(first, count),
+                            std::span<const float>(rayDirY).subspan(first, count),
+                            cosines.subspan(first, count),
+                            static_cast<float>(playerX), static_cast<float>(playerY), map);
+        });
 
-        // Calculate and display the walls.
-        for (int i = 0; i < NUMBER_OF_RAYS; i++)
+#ifndef RAYCASTER_FIXED_POINT
+        // Store new hits after the parallel pass, so chunks only ever read the cache.
+        for (int i = 0; i < numberOfRays; i++)
         {
-            constexpr float wallWidth = static_cast<float>(SCREEN_WIDTH) / static_cast<float>(NUMBER_OF_RAYS);
+            if (!isCached.at(i))
+                hitCache.store(rayAngles.at(i), hits.at(i));
+        }
+#endif
 
-            constexpr float halfWall = 1 * 0.5f;
-            const float projectionPlaneY = distanceToProjectionPlane * (halfWall / rays.at(i).distance);
-            const float wallHeight = SCREEN_HEIGHT * ((projectionPlaneY * 2) / projectionPlaneHeight);
+        // Floor and ceiling rows past the fog show it instead. The band they leave around the horizon is
+        // the height of a wall at the fog distance, which every nearer wall covers.
+        const rendering::Camera camera = rendering::Camera::fromAngle(playerAngle, columnTable.getPlaneScale());
+        floorRows.project(camera, static_cast<float>(playerX), static_cast<float>(playerY), columnTable.getOffsets(), projection);
 
-            wallRect.x = i * RAY_RES;
-            wallRect.y = (SCREEN_HEIGHT * 0.5f) - (wallHeight * 0.5f);
-            wallRect.w = wallWidth;
-            wallRect.h = wallHeight;
+        const int fogRows = floorRows.size() - floorRows.getFirstVisible();
+        framebuffer.fillRows(fogRows, SCREEN_HEIGHT - fogRows, fogColour);
 
-            // int colour = rays.at(i).colour * (1 / rays.at(i).distance * 5);
-            // colour = std::clamp(colour, 30, 255);
+        wallColumns.project(hitBuffer, projection, wallTextures);
+        rendering::drawFloors(framebuffer, floorRows, wallColumns, wallTextures, FLOOR_MATERIAL, CEILING_MATERIAL,
+                              colormap, rayRes);
 
-            int colour = std::floor(rays.at(i).colour * (1 - rays.at(i).distance / 8));
-            colour = std::clamp(colour, 0, 255);
+        // Draw the walls. Misses and walls past the fog cover no rows.
+        rendering::drawWalls(framebuffer, wallColumns, wallTextures, colormap, rayRes);
 
-            // const int colour = rays.at(i).colour;
+        if (!uploadFrame(framebuffer, paletteColours))
+            SDL_Log("Failed to upload the frame. Error: %s", SDL_GetError());
 
-            SDL_SetRenderDrawColor(renderer, colour, colour, colour, 255);
+        SDL_SetRenderDrawColorFloat(renderer, 0.0f, 0.0f, 0.0f, 0.0f);
+        SDL_RenderClear(renderer);
 
-            SDL_RenderFillRect(renderer, &wallRect);
-        }
+        // Stretch the part of the texture drawn this frame across the screen.
+        const SDL_FRect drawnArea{0.0f, 0.0f, static_cast<float>(renderWidth), static_cast<float>(SCREEN_HEIGHT)};
+        SDL_RenderTexture(renderer, frameTexture, &drawnArea, nullptr);
 
         SDL_RenderPresent(renderer);
     }
 
+    SDL_DestroyTexture(frameTexture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();